@@ -0,0 +1,697 @@
+#include "FTiXExportSession.h"
+#include "Engine/World.h"
+#include "Engine/ReflectionCapture.h"
+#include "Engine/StaticMeshActor.h"
+#include "Animation/SkeletalMeshActor.h"
+#include "InstancedFoliageActor.h"
+#include "Components/ReflectionCaptureComponent.h"
+#include "Runtime/Engine/Classes/Components/SkyLightComponent.h"
+#include "RenderingThread.h"
+#include "Misc/ScopeLock.h"
+#include "UObject/Package.h"
+#include "Materials/MaterialInstance.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/Texture.h"
+#include "EngineUtils.h"
+#include "Components/StaticMeshComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "SceneInterface.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Serialization/JsonReader.h"
+#include "Serialization/JsonWriter.h"
+#include "Serialization/JsonSerializer.h"
+#include "TiXExporterBPLibrary.h"
+#include "TiXExporterHelper.h"
+
+static const FString ExportCacheDir = TEXT(".tixcache/");
+static const FString ExportCacheName = TEXT("export_cache.json");
+
+FTiXExportSession& FTiXExportSession::Get()
+{
+	static FTiXExportSession Session;
+	return Session;
+}
+
+FTiXExportSession::FTiXExportSession()
+	: bActive(false)
+	, SettingsHash(0)
+	, bUseExportCache(false)
+	, SkippedExportRequests(0)
+	, UpToDateAssets(0)
+	, UpToDateTiles(0)
+	, TrackedTileSize(0.f)
+	, TrackedPositionScale(0.f)
+	, TrackedSettingsHash(0)
+	, SceneChangeCounter(0)
+	, CapturedSceneChangeCounter(0)
+	, CaptureStateHash(0)
+	, bHasCaptures(false)
+{
+}
+
+void FTiXExportSession::BeginSession(const FString& InExportPath, uint32 InSettingsHash, bool bInUseExportCache)
+{
+	check(!bActive);
+	bActive = true;
+	RawExportPath = InExportPath;
+	ExportPath = InExportPath;
+	ExportPath.ReplaceInline(TEXT("\\"), TEXT("/"));
+	if (!ExportPath.EndsWith(TEXT("/")))
+		ExportPath.AppendChar('/');
+	SettingsHash = InSettingsHash;
+	bUseExportCache = bInUseExportCache;
+
+	ExportedAssets.Empty();
+	SkippedExportRequests = 0;
+	UpToDateAssets = 0;
+	UpToDateTiles = 0;
+	ResourceIds.Empty();
+	ResourcePaths.Empty();
+	DependencyClosures.Empty();
+	PipelineStates.Empty();
+	CreatedDirectories.Empty();
+
+	LoadExportCache();
+}
+
+void FTiXExportSession::EndSession()
+{
+	check(bActive);
+	bActive = false;
+	UE_LOG(LogTiXExporter, Log, TEXT("Exported %d assets, skipped %d repeated export requests."), ExportedAssets.Num() - UpToDateAssets, SkippedExportRequests);
+	if (bUseExportCache)
+	{
+		UE_LOG(LogTiXExporter, Log, TEXT("Export cache: %d assets and %d tiles are up to date."), UpToDateAssets, UpToDateTiles);
+		SaveExportCache();
+	}
+	ExportedAssets.Empty();
+	CachedAssetKeys.Empty();
+	CachedTileKeys.Empty();
+	ResourceIds.Empty();
+	ResourcePaths.Empty();
+	DependencyClosures.Empty();
+	PipelineStates.Empty();
+	CreatedDirectories.Empty();
+	GeneratedLODs.Empty();
+}
+
+/** Tiles an actor is sorted into when exporting scene tiles. */
+static void GetActorTiles(const AActor* Actor, float TileSize, float PositionScale, TArray<FIntPoint>& OutTiles)
+{
+	auto AddTile = [&OutTiles, TileSize](const FVector& Position)
+	{
+		if (!Position.ContainsNaN())
+		{
+			OutTiles.AddUnique(GetPointByPosition(Position, TileSize));
+		}
+	};
+
+	if (const AInstancedFoliageActor* FoliageActor = Cast<AInstancedFoliageActor>(Actor))
+	{
+		for (const auto& FoliagePair : FoliageActor->FoliageInfos)
+		{
+			const UHierarchicalInstancedStaticMeshComponent* MeshComponent = FoliagePair.Value->GetComponent();
+			if (MeshComponent != nullptr)
+			{
+				for (const FInstancedStaticMeshInstanceData& InstanceData : MeshComponent->PerInstanceSMData)
+				{
+					AddTile(InstanceData.Transform.GetOrigin() * PositionScale);
+				}
+			}
+		}
+	}
+	else if (Actor->IsA<AStaticMeshActor>() || Actor->IsA<ASkeletalMeshActor>() || Actor->IsA<AReflectionCapture>())
+	{
+		AddTile(Actor->GetActorLocation() * PositionScale);
+	}
+}
+
+void FTiXExportSession::BeginTileTracking(const UWorld* World, const FString& InExportPath, float InTileSize, float InPositionScale, uint32 InSettingsHash)
+{
+	check(IsInGameThread());
+	TrackedWorld = World;
+	TrackedExportPath = NormalizeExportPath(InExportPath);
+	TrackedTileSize = InTileSize;
+	TrackedPositionScale = InPositionScale;
+	TrackedSettingsHash = InSettingsHash;
+	TrackedActorTiles.Empty();
+	DirtyTiles.Empty();
+}
+
+bool FTiXExportSession::IsTrackingTiles(const UWorld* World, const FString& InExportPath, float InTileSize, float InPositionScale, uint32 InSettingsHash) const
+{
+	return TrackedWorld.IsValid() && 
+		TrackedWorld.Get() == World &&
+		TrackedExportPath == NormalizeExportPath(InExportPath) &&
+		TrackedTileSize == InTileSize &&
+		TrackedPositionScale == InPositionScale &&
+		TrackedSettingsHash == InSettingsHash;
+}
+
+void FTiXExportSession::TrackActorTiles(const AActor* Actor)
+{
+	TArray<FIntPoint> ActorTiles;
+	GetActorTiles(Actor, TrackedTileSize, TrackedPositionScale, ActorTiles);
+	if (ActorTiles.Num() > 0)
+	{
+		TrackedActorTiles.Add(Actor, MoveTemp(ActorTiles));
+	}
+}
+
+void FTiXExportSession::NotifyActorChanged(const AActor* Actor, bool bRemoved)
+{
+	if (Actor == nullptr || !TrackedWorld.IsValid() || Actor->GetWorld() != TrackedWorld.Get())
+	{
+		return;
+	}
+
+	// Tiles actor was in
+	TArray<FIntPoint> OldTiles;
+	if (TrackedActorTiles.RemoveAndCopyValue(Actor, OldTiles))
+	{
+		DirtyTiles.Append(OldTiles);
+	}
+
+	// Tiles actor is in now
+	if (!bRemoved)
+	{
+		TrackActorTiles(Actor);
+		if (const TArray<FIntPoint>* NewTiles = TrackedActorTiles.Find(Actor))
+		{
+			DirtyTiles.Append(*NewTiles);
+		}
+	}
+}
+
+/** Return true if the material or its parents are the asset, or use it as a texture. */
+static bool DoesMaterialUseAsset(const UMaterialInterface* Material, const UObject* Asset, TMap<const UMaterialInterface*, bool>& InOutResults)
+{
+	if (const bool* Result = InOutResults.Find(Material))
+	{
+		return *Result;
+	}
+
+	TArray<const UMaterialInterface*> Chain;
+	GetMaterialParentChain(Material, Chain);
+	bool bUsesAsset = Chain.Contains(Asset);
+	if (!bUsesAsset && Asset->IsA<UTexture>())
+	{
+		TArray<UTexture*> Textures;
+		Material->GetUsedTextures(Textures, EMaterialQualityLevel::Num, true, ERHIFeatureLevel::Num, true);
+		bUsesAsset = Textures.Contains(Asset);
+	}
+	InOutResults.Add(Material, bUsesAsset);
+	return bUsesAsset;
+}
+
+void FTiXExportSession::NotifyAssetChanged(const UObject* Asset)
+{
+	UWorld* World = const_cast<UWorld*>(TrackedWorld.Get());
+	if (Asset == nullptr || World == nullptr)
+	{
+		return;
+	}
+
+	// Duplicates are found over the whole scene, dirty tiles can not tell if they still hold
+	if (IsInDuplicates(Asset))
+	{
+		UE_LOG(LogTiXExporter, Log, TEXT("%s is in duplicates of last full export, next export is a full export."), *Asset->GetName());
+		TrackedWorld.Reset();
+		return;
+	}
+
+	// Tracked actors drawing the asset, actors of the world are alive here
+	TMap<const UMaterialInterface*, bool> MaterialResults;
+	TArray<UMaterialInterface*> Materials;
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		const AActor* Actor = *It;
+		if (!TrackedActorTiles.Contains(Actor))
+		{
+			continue;
+		}
+
+		bool bUsesAsset = false;
+		TInlineComponentArray<UPrimitiveComponent*> Components(Actor);
+		for (int32 Index = 0; Index < Components.Num() && !bUsesAsset; ++Index)
+		{
+			const UPrimitiveComponent* Component = Components[Index];
+			if (const UStaticMeshComponent* SMComponent = Cast<UStaticMeshComponent>(Component))
+			{
+				bUsesAsset = SMComponent->GetStaticMesh() == Asset;
+			}
+			else if (const USkeletalMeshComponent* SKMComponent = Cast<USkeletalMeshComponent>(Component))
+			{
+				bUsesAsset = SKMComponent->SkeletalMesh == Asset;
+			}
+
+			Materials.Reset();
+			Component->GetUsedMaterials(Materials);
+			for (int32 MaterialIndex = 0; MaterialIndex < Materials.Num() && !bUsesAsset; ++MaterialIndex)
+			{
+				bUsesAsset = Materials[MaterialIndex] != nullptr && DoesMaterialUseAsset(Materials[MaterialIndex], Asset, MaterialResults);
+			}
+		}
+		if (bUsesAsset)
+		{
+			NotifyActorChanged(Actor, false);
+		}
+	}
+}
+
+bool FTiXExportSession::IsInDuplicates(const UObject* Asset) const
+{
+	if (DuplicatedMeshes.Contains(Asset))
+	{
+		return true;
+	}
+	for (const auto& DuplicatePair : TextureDuplicates)
+	{
+		if (DuplicatePair.Key == Asset || DuplicatePair.Value.Representative == Asset)
+		{
+			return true;
+		}
+	}
+
+	// Material instances are compared with parameters of their parents
+	TArray<const UMaterialInterface*> Chain;
+	for (const auto& DuplicatePair : MaterialInstanceDuplicates)
+	{
+		Chain.Reset();
+		GetMaterialParentChain(DuplicatePair.Key, Chain);
+		GetMaterialParentChain(DuplicatePair.Value, Chain);
+		if (Chain.Contains(Asset))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+TSet<FIntPoint> FTiXExportSession::ConsumeDirtyTiles()
+{
+	TSet<FIntPoint> Result = MoveTemp(DirtyTiles);
+	DirtyTiles.Empty();
+	return Result;
+}
+
+bool FTiXExportSession::AreCapturesUpToDate(uint32 InCaptureStateHash) const
+{
+	return bHasCaptures && CaptureStateHash == InCaptureStateHash && CapturedSceneChangeCounter == SceneChangeCounter;
+}
+
+void FTiXExportSession::ResetCaptures(uint32 InCaptureStateHash)
+{
+	// Take the counter before capturing, so changes during capture trigger another recapture
+	bHasCaptures = true;
+	CaptureStateHash = InCaptureStateHash;
+	CapturedSceneChangeCounter = SceneChangeCounter;
+	ReflectionCaptureData.Empty();
+	SkyIrradiance.Empty();
+	ExportedCaptureFiles.Empty();
+}
+
+void FTiXExportSession::ReadbackReflectionCaptures(UWorld* World, const TArray<AReflectionCapture*>& RCActors)
+{
+	if (World == nullptr || World->Scene == nullptr)
+	{
+		return;
+	}
+
+	// Drain pending capture updates once, so each readback below only waits for its own copy.
+	FlushRenderingCommands();
+
+	ReflectionCaptureData.Reserve(ReflectionCaptureData.Num() + RCActors.Num());
+	for (AReflectionCapture* RCActor : RCActors)
+	{
+		UReflectionCaptureComponent* RCComponent = RCActor->GetCaptureComponent();
+		if (RCComponent == nullptr || ReflectionCaptureData.Contains(RCComponent))
+		{
+			continue;
+		}
+		FReflectionCaptureData& CaptureData = ReflectionCaptureData.Add(RCComponent);
+		World->Scene->GetReflectionCaptureData(RCComponent, CaptureData);
+	}
+	UE_LOG(LogTiXExporter, Log, TEXT("  Read back %d reflection captures."), ReflectionCaptureData.Num());
+}
+
+const FReflectionCaptureData* FTiXExportSession::FindReflectionCaptureData(const UReflectionCaptureComponent* RCComponent) const
+{
+	return ReflectionCaptureData.Find(RCComponent);
+}
+
+bool FTiXExportSession::IsCaptureFileUpToDate(const FString& FileName) const
+{
+	return bHasCaptures &&
+		CapturedSceneChangeCounter == SceneChangeCounter &&
+		ExportedCaptureFiles.Contains(FileName) &&
+		FPaths::FileExists(FileName);
+}
+
+void FTiXExportSession::MarkCaptureFileExported(const FString& FileName)
+{
+	ExportedCaptureFiles.Add(FileName);
+}
+
+void FTiXExportSession::ReadbackSkyLight(USkyLightComponent* SkyLightComponent)
+{
+	if (SkyLightComponent != nullptr)
+	{
+		SkyIrradiance.Add(SkyLightComponent, SkyLightComponent->GetIrradianceEnvironmentMap());
+	}
+}
+
+const FSHVectorRGB3* FTiXExportSession::FindSkyIrradiance(const USkyLightComponent* SkyLightComponent) const
+{
+	return SkyIrradiance.Find(SkyLightComponent);
+}
+
+bool FTiXExportSession::TryBeginExport(const UObject* Asset)
+{
+	if (!bActive)
+	{
+		// Export functions called directly always do the work
+		return true;
+	}
+
+	FScopeLock Lock(&ExportedAssetsLock);
+	if (ExportedAssets.Contains(Asset))
+	{
+		++SkippedExportRequests;
+		return false;
+	}
+
+	if (IsAssetUpToDate(Asset))
+	{
+		ExportedAssets.Add(Asset, EAssetExportState::Exported);
+		++UpToDateAssets;
+		return false;
+	}
+
+	ExportedAssets.Add(Asset, EAssetExportState::InProgress);
+	return true;
+}
+
+bool FTiXExportSession::IsAssetUpToDate(const UObject* Asset) const
+{
+	if (!bActive || !bUseExportCache)
+	{
+		return false;
+	}
+	const FString AssetPathName = GetResourcePathName(Asset);
+	const FString* CachedKey = CachedAssetKeys.Find(AssetPathName);
+	return CachedKey != nullptr &&
+		*CachedKey == GetAssetCacheKey(Asset) &&
+		FPaths::FileExists(ExportPath + AssetPathName + TEXT(".tjs"));
+}
+
+void FTiXExportSession::EndExport(const UObject* Asset, bool bSucceeded)
+{
+	if (!bActive)
+	{
+		return;
+	}
+
+	FScopeLock Lock(&ExportedAssetsLock);
+	EAssetExportState* State = ExportedAssets.Find(Asset);
+	check(State != nullptr && *State == EAssetExportState::InProgress);
+	*State = EAssetExportState::Exported;
+
+	if (bUseExportCache)
+	{
+		// A file left by an earlier run must not look up to date after a failed export
+		const FString AssetKey = bSucceeded ? GetAssetCacheKey(Asset) : FString();
+		if (AssetKey.IsEmpty())
+		{
+			CachedAssetKeys.Remove(GetResourcePathName(Asset));
+		}
+		else
+		{
+			CachedAssetKeys.Add(GetResourcePathName(Asset), AssetKey);
+		}
+	}
+}
+
+void FTiXExportSession::ResetDuplicates()
+{
+	TextureDuplicates.Empty();
+	MaterialInstanceDuplicates.Empty();
+	DuplicatedMeshes.Empty();
+}
+
+void FTiXExportSession::SetMeshDuplicates(const TMap<UStaticMesh*, FTiXMeshDuplicate>& InMeshDuplicates)
+{
+	check(bActive);
+	DuplicatedMeshes.Empty();
+	for (const auto& DuplicatePair : InMeshDuplicates)
+	{
+		DuplicatedMeshes.Add(DuplicatePair.Key);
+		DuplicatedMeshes.Add(DuplicatePair.Value.Representative);
+	}
+}
+
+void FTiXExportSession::SetTextureDuplicates(const TMap<const UTexture*, FTiXTextureDuplicate>& InTextureDuplicates)
+{
+	check(bActive);
+	TextureDuplicates = InTextureDuplicates;
+}
+
+void FTiXExportSession::SetMaterialInstanceDuplicates(const TMap<const UMaterialInterface*, UMaterialInterface*>& InMaterialInstanceDuplicates)
+{
+	check(bActive);
+	MaterialInstanceDuplicates = InMaterialInstanceDuplicates;
+}
+
+void FTiXExportSession::AddMaterialMappingKey(const UMaterialInterface* MaterialInterface, FString& InOutKey) const
+{
+	// Pointers differ between runs, path names do not
+	if (UMaterialInterface* const* Representative = MaterialInstanceDuplicates.Find(MaterialInterface))
+	{
+		InOutKey += FString::Printf(TEXT("|%s=%s"), *MaterialInterface->GetPathName(), *(*Representative)->GetPathName());
+	}
+}
+
+FString FTiXExportSession::GetAssetCacheKey(const UObject* Asset) const
+{
+	// Material instances bake in parameters of their parents, so they depend on the whole chain
+	TArray<const UObject*> Sources;
+	if (const UMaterialInterface* MaterialInterface = Cast<UMaterialInterface>(Asset))
+	{
+		TArray<const UMaterialInterface*> MaterialChain;
+		GetMaterialParentChain(MaterialInterface, MaterialChain);
+		Sources.Append(MaterialChain);
+	}
+	else
+	{
+		Sources.Add(Asset);
+	}
+
+	FString Key;
+	for (const UObject* Source : Sources)
+	{
+		// Only saved content assets have a package guid that describes their content
+		const UPackage* Package = Source->GetOutermost();
+		if (Package->IsDirty() || !Package->GetName().StartsWith(TEXT("/Game/")))
+		{
+			return FString();
+		}
+		Key += Package->GetGuid().ToString();
+		Key += TEXT("-");
+	}
+	Key += FString::Printf(TEXT("%08x"), SettingsHash);
+
+	// Deduplication entries this asset uses, other entries do not change its output
+	for (const UObject* Source : Sources)
+	{
+		if (const UMaterialInstance* MaterialInstance = Cast<UMaterialInstance>(Source))
+		{
+			for (const FTextureParameterValue& Value : MaterialInstance->TextureParameterValues)
+			{
+				if (const FTiXTextureDuplicate* Duplicate = TextureDuplicates.Find(Value.ParameterValue))
+				{
+					Key += FString::Printf(TEXT("|%s=%s@%d"), *Value.ParameterValue->GetPathName(), *Duplicate->Representative->GetPathName(), Duplicate->MipBias);
+				}
+			}
+		}
+	}
+	if (const UStaticMesh* StaticMesh = Cast<UStaticMesh>(Asset))
+	{
+		for (const FStaticMaterial& Material : StaticMesh->StaticMaterials)
+		{
+			AddMaterialMappingKey(Material.MaterialInterface, Key);
+		}
+	}
+	else if (const USkeletalMesh* SkeletalMesh = Cast<USkeletalMesh>(Asset))
+	{
+		for (const FSkeletalMaterial& Material : SkeletalMesh->Materials)
+		{
+			AddMaterialMappingKey(Material.MaterialInterface, Key);
+		}
+	}
+	return Key;
+}
+
+bool FTiXExportSession::IsSceneTileUpToDate(const FString& TilePathName, const FString& TileKey)
+{
+	if (!bActive || !bUseExportCache || TileKey.IsEmpty())
+	{
+		return false;
+	}
+	const FString* CachedKey = CachedTileKeys.Find(TilePathName);
+	if (CachedKey != nullptr &&
+		*CachedKey == TileKey &&
+		FPaths::FileExists(ExportPath + TilePathName + TEXT(".tjs")))
+	{
+		++UpToDateTiles;
+		return true;
+	}
+	return false;
+}
+
+void FTiXExportSession::MarkSceneTileExported(const FString& TilePathName, const FString& TileKey)
+{
+	if (!bActive || !bUseExportCache)
+	{
+		return;
+	}
+	if (TileKey.IsEmpty())
+	{
+		CachedTileKeys.Remove(TilePathName);
+	}
+	else
+	{
+		CachedTileKeys.Add(TilePathName, TileKey);
+	}
+}
+
+int32 FTiXExportSession::InternResource(const UObject* Resource)
+{
+	check(IsInGameThread());
+	const int32* ResourceId = ResourceIds.Find(Resource);
+	if (ResourceId != nullptr)
+	{
+		return *ResourceId;
+	}
+	FTiXResourcePaths* Paths = new FTiXResourcePaths;
+	CalcResourcePaths(Resource, Paths->Path, Paths->PathName);
+	Paths->ExportPath = ExportPath + Paths->Path;
+	const int32 NewId = ResourcePaths.Add(Paths);
+	ResourceIds.Add(Resource, NewId);
+	return NewId;
+}
+
+bool FTiXExportSession::IsDirectoryCreated(const FString& Dir) const
+{
+	if (!bActive)
+	{
+		// Directories may be removed between direct export calls
+		return false;
+	}
+	FScopeLock Lock(&CreatedDirectoriesLock);
+	return CreatedDirectories.Contains(Dir);
+}
+
+void FTiXExportSession::MarkDirectoryCreated(const FString& Dir)
+{
+	if (!bActive)
+	{
+		return;
+	}
+	FScopeLock Lock(&CreatedDirectoriesLock);
+	CreatedDirectories.Add(Dir);
+}
+
+const FDependency* FTiXExportSession::FindDependencyClosure(const UObject* Resource) const
+{
+	return DependencyClosures.Find(Resource);
+}
+
+FDependency& FTiXExportSession::AddDependencyClosure(const UObject* Resource)
+{
+	check(IsInGameThread() && !DependencyClosures.Contains(Resource));
+	return DependencyClosures.Add(Resource);
+}
+
+FString FTiXExportSession::GetExportCacheFileName() const
+{
+	return ExportPath + ExportCacheDir + ExportCacheName;
+}
+
+void FTiXExportSession::LoadExportCache()
+{
+	CachedAssetKeys.Empty();
+	CachedTileKeys.Empty();
+	if (!bUseExportCache)
+	{
+		return;
+	}
+
+	FString JsonString;
+	if (!FFileHelper::LoadFileToString(JsonString, *GetExportCacheFileName()))
+	{
+		return;
+	}
+
+	TSharedPtr<FJsonObject> JsonObject;
+	TSharedRef< TJsonReader<TCHAR> > Reader = TJsonReaderFactory<TCHAR>::Create(JsonString);
+	if (!FJsonSerializer::Deserialize(Reader, JsonObject) || !JsonObject.IsValid())
+	{
+		UE_LOG(LogTiXExporter, Warning, TEXT("Invalid export cache %s, export everything."), *GetExportCacheFileName());
+		return;
+	}
+
+	int32 CacheVersion = 0;
+	if (!JsonObject->TryGetNumberField(TEXT("version"), CacheVersion) || CacheVersion != TIX_EXPORT_CACHE_VERSION)
+	{
+		return;
+	}
+
+	const TSharedPtr<FJsonObject>* JAssets;
+	if (JsonObject->TryGetObjectField(TEXT("assets"), JAssets))
+	{
+		for (const auto& AssetPair : (*JAssets)->Values)
+		{
+			CachedAssetKeys.Add(AssetPair.Key, AssetPair.Value->AsString());
+		}
+	}
+	const TSharedPtr<FJsonObject>* JTiles;
+	if (JsonObject->TryGetObjectField(TEXT("tiles"), JTiles))
+	{
+		for (const auto& TilePair : (*JTiles)->Values)
+		{
+			CachedTileKeys.Add(TilePair.Key, TilePair.Value->AsString());
+		}
+	}
+}
+
+void FTiXExportSession::SaveExportCache() const
+{
+	TSharedPtr<FJsonObject> JsonObject = MakeShareable(new FJsonObject);
+	JsonObject->SetNumberField(TEXT("version"), TIX_EXPORT_CACHE_VERSION);
+
+	TSharedPtr<FJsonObject> JAssets = MakeShareable(new FJsonObject);
+	for (const auto& AssetPair : CachedAssetKeys)
+	{
+		JAssets->SetStringField(AssetPair.Key, AssetPair.Value);
+	}
+	JsonObject->SetObjectField(TEXT("assets"), JAssets);
+
+	TSharedPtr<FJsonObject> JTiles = MakeShareable(new FJsonObject);
+	for (const auto& TilePair : CachedTileKeys)
+	{
+		JTiles->SetStringField(TilePair.Key, TilePair.Value);
+	}
+	JsonObject->SetObjectField(TEXT("tiles"), JTiles);
+
+	FString OutputString;
+	TSharedRef< TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR> > > Writer = TJsonWriterFactory<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>::Create(&OutputString);
+	FJsonSerializer::Serialize(JsonObject.ToSharedRef(), Writer);
+
+	FString CachePath = ExportPath + ExportCacheDir;
+	if (!VerifyOrCreateDirectory(CachePath) || !FFileHelper::SaveStringToFile(OutputString, *GetExportCacheFileName()))
+	{
+		UE_LOG(LogTiXExporter, Error, TEXT("Failed to save export cache : %s."), *GetExportCacheFileName());
+	}
+}
@@ -0,0 +1,277 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Math/SHMath.h"
+#include "HAL/CriticalSection.h"
+#include "Engine/MapBuildDataRegistry.h"
+#include "Dom/JsonObject.h"
+#include "TiXExporterDefines.h"
+
+class UWorld;
+class AActor;
+class AReflectionCapture;
+class UReflectionCaptureComponent;
+class USkyLightComponent;
+class UTexture;
+class UMaterialInterface;
+
+/** Paths of a resource, computed once in a session. */
+struct FTiXResourcePaths
+{
+	// Directory relative to export path, e.g. "Meshes/Props/"
+	FString Path;
+	// Path with resource name, e.g. "Meshes/Props/SM_Chair"
+	FString PathName;
+	// Directory in export path, e.g. "D:/Export/Meshes/Props/"
+	FString ExportPath;
+};
+
+/**
+* States shared by all export functions during one export run.
+* Created by ExportCurrentScene, export functions called outside of a run still work without it.
+*/
+class FTiXExportSession
+{
+public:
+	static FTiXExportSession& Get();
+
+	void BeginSession(const FString& InExportPath, uint32 InSettingsHash, bool bInUseExportCache);
+	void EndSession();
+
+	bool IsActive() const
+	{
+		return bActive;
+	}
+
+	/** Export path as passed to BeginSession. */
+	const FString& GetRawExportPath() const
+	{
+		return RawExportPath;
+	}
+
+	/** Export path with '/' separators and a '/' in the end. */
+	const FString& GetExportPath() const
+	{
+		return ExportPath;
+	}
+
+	// Scene captures, results are kept across sessions until scene changes
+	/** Called by editor events when anything may affect captures. */
+	void NotifySceneChanged()
+	{
+		++SceneChangeCounter;
+	}
+	/** Return true if captures are read back with the same capture state and scene is not changed since then. */
+	bool AreCapturesUpToDate(uint32 InCaptureStateHash) const;
+	/** Drop captured data, captures read back after this are recorded with InCaptureStateHash. */
+	void ResetCaptures(uint32 InCaptureStateHash);
+
+	// Scene tiles of actors, kept across sessions for dirty tile export, game thread only
+	/** Forget tracked actors and dirty tiles, start tracking a newly exported scene. */
+	void BeginTileTracking(const UWorld* World, const FString& InExportPath, float InTileSize, float InPositionScale, uint32 InSettingsHash);
+	bool IsTrackingTiles(const UWorld* World, const FString& InExportPath, float InTileSize, float InPositionScale, uint32 InSettingsHash) const;
+	bool IsTrackedWorld(const UWorld* World) const
+	{
+		return World != nullptr && TrackedWorld.Get() == World;
+	}
+	void TrackActorTiles(const AActor* Actor);
+	/** Mark tiles of actor before and after the change dirty. */
+	void NotifyActorChanged(const AActor* Actor, bool bRemoved);
+	/** Mark tiles of actors using the asset dirty, or stop tracking if the asset is in duplicates found by the full export. */
+	void NotifyAssetChanged(const UObject* Asset);
+	/** Queue a tile again, e.g. its export failed. */
+	void AddDirtyTile(const FIntPoint& Tile)
+	{
+		DirtyTiles.Add(Tile);
+	}
+	TSet<FIntPoint> ConsumeDirtyTiles();
+
+	// Reflection captures
+	/** Read back cubemaps of all captures in one go. */
+	void ReadbackReflectionCaptures(UWorld* World, const TArray<AReflectionCapture*>& RCActors);
+	const FReflectionCaptureData* FindReflectionCaptureData(const UReflectionCaptureComponent* RCComponent) const;
+	/** Return true if the file is written from current captures and still exists, so it can be kept as is. */
+	bool IsCaptureFileUpToDate(const FString& FileName) const;
+	void MarkCaptureFileExported(const FString& FileName);
+
+	// Sky light
+	void ReadbackSkyLight(USkyLightComponent* SkyLightComponent);
+	const FSHVectorRGB3* FindSkyIrradiance(const USkyLightComponent* SkyLightComponent) const;
+
+	// Exported assets
+	/** Return true if caller should export this asset, false if it is already exported or in progress in this session. */
+	bool TryBeginExport(const UObject* Asset);
+	/** Only successful exports are recorded in the export cache, failed ones are exported again next time. */
+	void EndExport(const UObject* Asset, bool bSucceeded);
+	/** Exported by a previous run and not changed since then. */
+	bool IsAssetUpToDate(const UObject* Asset) const;
+
+	// Incremental export cache, persistent across runs
+	/** Key of asset content with current settings, empty if this asset can not be cached. */
+	FString GetAssetCacheKey(const UObject* Asset) const;
+	/** TilePathName is relative to export path, e.g. "WorldName/t0_0". */
+	bool IsSceneTileUpToDate(const FString& TilePathName, const FString& TileKey);
+	void MarkSceneTileExported(const FString& TilePathName, const FString& TileKey);
+
+	// Interned resources, game thread only
+	/** Return a session unique id of the resource, which maps to its paths. */
+	int32 InternResource(const UObject* Resource);
+	const FString& GetInternedResourcePathName(int32 ResourceId) const
+	{
+		return ResourcePaths[ResourceId].PathName;
+	}
+	const FTiXResourcePaths& GetResourcePaths(const UObject* Resource)
+	{
+		return ResourcePaths[InternResource(Resource)];
+	}
+
+	// Directories known to exist in this session, thread safe
+	bool IsDirectoryCreated(const FString& Dir) const;
+	void MarkDirectoryCreated(const FString& Dir);
+
+	// Deduplication mappings of the last full scene export, kept across sessions for dirty tile export
+	/** Forget mappings, before a full scene export finds duplicates again. */
+	void ResetDuplicates();
+	/** Meshes folded into others and their representatives, only checked when these meshes change. */
+	void SetMeshDuplicates(const TMap<UStaticMesh*, FTiXMeshDuplicate>& InMeshDuplicates);
+
+	// Duplicated textures, exported and referenced as their representatives
+	/** Also changes cache keys of material instances using a duplicated texture. */
+	void SetTextureDuplicates(const TMap<const UTexture*, FTiXTextureDuplicate>& InTextureDuplicates);
+	const FTiXTextureDuplicate* FindTextureDuplicate(const UTexture* Texture) const
+	{
+		return bActive ? TextureDuplicates.Find(Texture) : nullptr;
+	}
+
+	// Merged material instances, exported and referenced as their representatives
+	/** Also changes cache keys of meshes using a merged material instance. */
+	void SetMaterialInstanceDuplicates(const TMap<const UMaterialInterface*, UMaterialInterface*>& InMaterialInstanceDuplicates);
+	UMaterialInterface* FindMaterialInstanceRepresentative(const UMaterialInterface* MaterialInstance) const
+	{
+		UMaterialInterface* const* Representative = bActive ? MaterialInstanceDuplicates.Find(MaterialInstance) : nullptr;
+		return Representative != nullptr ? *Representative : nullptr;
+	}
+
+	// Pipeline states of materials in this session, game thread only
+	void AddPipelineState(const FString& Name, TSharedPtr<FJsonObject> PipelineState)
+	{
+		PipelineStates.Add(Name, PipelineState);
+	}
+	const TMap<FString, TSharedPtr<FJsonObject> >& GetPipelineStates() const
+	{
+		return PipelineStates;
+	}
+
+	// Dependency closures of meshes, game thread only
+	const FDependency* FindDependencyClosure(const UObject* Resource) const;
+	FDependency& AddDependencyClosure(const UObject* Resource);
+
+	// LODs simplified for meshes before they are exported, game thread only
+	void SetGeneratedLODs(const UObject* Mesh, TArray<FTiXGeneratedLOD>&& LODs)
+	{
+		GeneratedLODs.Add(Mesh, MoveTemp(LODs));
+	}
+	const TArray<FTiXGeneratedLOD>* FindGeneratedLODs(const UObject* Mesh) const
+	{
+		return GeneratedLODs.Find(Mesh);
+	}
+
+private:
+	FTiXExportSession();
+
+	FString GetExportCacheFileName() const;
+	void LoadExportCache();
+	void SaveExportCache() const;
+	bool IsInDuplicates(const UObject* Asset) const;
+	/** Append the merged material instance entry of a mesh material to a cache key. */
+	void AddMaterialMappingKey(const UMaterialInterface* MaterialInterface, FString& InOutKey) const;
+
+private:
+	bool bActive;
+
+	FString RawExportPath;
+	FString ExportPath;
+	uint32 SettingsHash;
+	bool bUseExportCache;
+
+	enum class EAssetExportState : uint8
+	{
+		InProgress,
+		Exported,
+	};
+	FCriticalSection ExportedAssetsLock;
+	TMap<const UObject*, EAssetExportState> ExportedAssets;
+	int32 SkippedExportRequests;
+
+	// Asset path name or tile path name -> cache key of last export
+	TMap<FString, FString> CachedAssetKeys;
+	TMap<FString, FString> CachedTileKeys;
+	int32 UpToDateAssets;
+	int32 UpToDateTiles;
+
+	TMap<const UObject*, int32> ResourceIds;
+	TIndirectArray<FTiXResourcePaths> ResourcePaths;
+	TMap<const UObject*, FDependency> DependencyClosures;
+	TMap<const UTexture*, FTiXTextureDuplicate> TextureDuplicates;
+	TMap<const UMaterialInterface*, UMaterialInterface*> MaterialInstanceDuplicates;
+	TSet<const UObject*> DuplicatedMeshes;
+	TMap<FString, TSharedPtr<FJsonObject> > PipelineStates;
+	TMap<const UObject*, TArray<FTiXGeneratedLOD> > GeneratedLODs;
+
+	mutable FCriticalSection CreatedDirectoriesLock;
+	TSet<FString> CreatedDirectories;
+
+	TWeakObjectPtr<const UWorld> TrackedWorld;
+	FString TrackedExportPath;
+	float TrackedTileSize;
+	float TrackedPositionScale;
+	uint32 TrackedSettingsHash;
+	// Actors are only used as keys, never dereferenced
+	TMap<const AActor*, TArray<FIntPoint> > TrackedActorTiles;
+	TSet<FIntPoint> DirtyTiles;
+
+	uint32 SceneChangeCounter;
+	uint32 CapturedSceneChangeCounter;
+	uint32 CaptureStateHash;
+	bool bHasCaptures;
+	TMap<const UReflectionCaptureComponent*, FReflectionCaptureData> ReflectionCaptureData;
+	TSet<FString> ExportedCaptureFiles;
+	TMap<const USkyLightComponent*, FSHVectorRGB3> SkyIrradiance;
+};
+
+/**
+* Claims an asset for exporting in current session, and marks it exported when goes out of scope.
+* Call MarkSucceeded() once the asset file is written, or the export is treated as failed.
+*/
+class FTiXScopedAssetExport
+{
+public:
+	explicit FTiXScopedAssetExport(const UObject* InAsset)
+		: Asset(InAsset)
+		, bShouldExport(FTiXExportSession::Get().TryBeginExport(InAsset))
+		, bSucceeded(false)
+	{}
+
+	~FTiXScopedAssetExport()
+	{
+		if (bShouldExport)
+		{
+			FTiXExportSession::Get().EndExport(Asset, bSucceeded);
+		}
+	}
+
+	bool ShouldExport() const
+	{
+		return bShouldExport;
+	}
+
+	void MarkSucceeded()
+	{
+		bSucceeded = true;
+	}
+
+private:
+	const UObject* Asset;
+	const bool bShouldExport;
+	bool bSucceeded;
+};
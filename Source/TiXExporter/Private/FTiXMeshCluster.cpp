@@ -26,12 +26,12 @@ FTiXMeshCluster::FTiXMeshCluster()
 {
 }
 
-FTiXMeshCluster::FTiXMeshCluster(const TArray<FTiXVertex>& InVertices, const TArray<int32>& InIndices, float PositionScale)
+FTiXMeshCluster::FTiXMeshCluster(const TArray<FVector>& InPositions, const TArray<int32>& InIndices, float PositionScale)
 {
-	P.Reserve(InVertices.Num());
-	for (const auto& V : InVertices)
+	P.Reserve(InPositions.Num());
+	for (const FVector& Position : InPositions)
 	{
-		P.Push(V.Position * PositionScale);
+		P.Push(Position * PositionScale);
 	}
 	BBox = FBox(P);
 	float Extent = BBox.GetExtent().Size() * 2.f;
@@ -9,7 +9,7 @@ class FTiXMeshCluster
 {
 public:
 	FTiXMeshCluster();
-	FTiXMeshCluster(const TArray<FTiXVertex>& InVertices, const TArray<int32>& InIndices, float PositionScale);
+	FTiXMeshCluster(const TArray<FVector>& InPositions, const TArray<int32>& InIndices, float PositionScale);
 	~FTiXMeshCluster();
 
 	void GenerateCluster(uint32 ClusterTriangles);
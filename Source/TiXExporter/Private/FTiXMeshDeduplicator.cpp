@@ -0,0 +1,406 @@
+
+#include "FTiXMeshDeduplicator.h"
+#include "Engine/StaticMesh.h"
+#include "StaticMeshResources.h"
+#include "Async/ParallelFor.h"
+#include "Algo/Sort.h"
+#include "Hash/CityHash.h"
+
+// Principal axes closer than this (relative to the largest) are treated as equal, e.g. for a cube.
+static const double AxisEpsilon = 1e-3;
+// Normalized skewness below this can not decide the direction of an axis, e.g. for a mirrored mesh.
+static const double SkewEpsilon = 1e-3;
+// UV quantization, UVs are not changed by a rigid transform
+static const float UVQuantization = 4096.f;
+// Tangent basis quantization in the canonical frame, coarser than 8 bit tangent encoding
+static const double TangentQuantization = 64.0;
+
+/** Eigen values and vectors of a symmetric 3x3 matrix by Jacobi rotations, vectors are columns of OutVectors. */
+static void JacobiEigen(double A[3][3], double OutValues[3], double OutVectors[3][3])
+{
+	for (int32 Row = 0; Row < 3; ++Row)
+	{
+		for (int32 Col = 0; Col < 3; ++Col)
+		{
+			OutVectors[Row][Col] = Row == Col ? 1.0 : 0.0;
+		}
+	}
+
+	static const int32 PQ[3][2] = { {0, 1}, {0, 2}, {1, 2} };
+	for (int32 Sweep = 0; Sweep < 50; ++Sweep)
+	{
+		const double Diagonal = FMath::Abs(A[0][0]) + FMath::Abs(A[1][1]) + FMath::Abs(A[2][2]);
+		const double OffDiagonal = FMath::Abs(A[0][1]) + FMath::Abs(A[0][2]) + FMath::Abs(A[1][2]);
+		if (OffDiagonal <= 1e-15 * Diagonal)
+		{
+			break;
+		}
+
+		for (int32 Rotation = 0; Rotation < 3; ++Rotation)
+		{
+			const int32 P = PQ[Rotation][0];
+			const int32 Q = PQ[Rotation][1];
+			if (A[P][Q] == 0.0)
+			{
+				continue;
+			}
+
+			// Rotation that zeros A[P][Q]
+			const double Theta = (A[Q][Q] - A[P][P]) / (2.0 * A[P][Q]);
+			const double T = (Theta >= 0.0 ? 1.0 : -1.0) / (FMath::Abs(Theta) + FMath::Sqrt(Theta * Theta + 1.0));
+			const double C = 1.0 / FMath::Sqrt(T * T + 1.0);
+			const double S = T * C;
+
+			for (int32 K = 0; K < 3; ++K)
+			{
+				const double AKP = A[K][P];
+				const double AKQ = A[K][Q];
+				A[K][P] = C * AKP - S * AKQ;
+				A[K][Q] = S * AKP + C * AKQ;
+			}
+			for (int32 K = 0; K < 3; ++K)
+			{
+				const double APK = A[P][K];
+				const double AQK = A[Q][K];
+				A[P][K] = C * APK - S * AQK;
+				A[Q][K] = S * APK + C * AQK;
+			}
+			for (int32 K = 0; K < 3; ++K)
+			{
+				const double VKP = OutVectors[K][P];
+				const double VKQ = OutVectors[K][Q];
+				OutVectors[K][P] = C * VKP - S * VKQ;
+				OutVectors[K][Q] = S * VKP + C * VKQ;
+			}
+		}
+	}
+
+	for (int32 Index = 0; Index < 3; ++Index)
+	{
+		OutValues[Index] = A[Index][Index];
+	}
+}
+
+void FTiXMeshDeduplicator::AddMesh(UStaticMesh* StaticMesh, bool bCanFold)
+{
+	FCanonicalMesh& CanonicalMesh = Meshes[Meshes.AddDefaulted()];
+	CanonicalMesh.Mesh = StaticMesh;
+	CanonicalMesh.bCanFold = bCanFold;
+	CanonicalMesh.bValid = false;
+	CanonicalMesh.Hash = 0;
+}
+
+void FTiXMeshDeduplicator::FindDuplicates()
+{
+	// Only reads cpu copies of render data, meshes are independent
+	ParallelFor(Meshes.Num(), [this](int32 Index)
+	{
+		Canonicalize(Meshes[Index]);
+	});
+
+	// Sort by path, so the same mesh represents its geometry in every run
+	Meshes.Sort([](const FCanonicalMesh& A, const FCanonicalMesh& B)
+	{
+		return A.Mesh->GetPathName() < B.Mesh->GetPathName();
+	});
+
+	// The first mesh of each geometry is the representative
+	TMultiMap<uint64, int32> Representatives;
+	TArray<int32> Candidates;
+	for (int32 Index = 0; Index < Meshes.Num(); ++Index)
+	{
+		const FCanonicalMesh& CanonicalMesh = Meshes[Index];
+		if (!CanonicalMesh.bValid)
+		{
+			continue;
+		}
+
+		// Hash collisions are resolved by comparing canonical data
+		int32 RepresentativeIndex = INDEX_NONE;
+		Candidates.Reset();
+		Representatives.MultiFind(CanonicalMesh.Hash, Candidates);
+		for (int32 Candidate : Candidates)
+		{
+			if (Meshes[Candidate].Materials == CanonicalMesh.Materials &&
+				Meshes[Candidate].Triangles == CanonicalMesh.Triangles)
+			{
+				RepresentativeIndex = Candidate;
+				break;
+			}
+		}
+
+		if (RepresentativeIndex == INDEX_NONE)
+		{
+			Representatives.Add(CanonicalMesh.Hash, Index);
+		}
+		else if (CanonicalMesh.bCanFold)
+		{
+			const FCanonicalMesh& Representative = Meshes[RepresentativeIndex];
+			FTiXMeshDuplicate& Duplicate = Duplicates.Add(CanonicalMesh.Mesh);
+			Duplicate.Representative = Representative.Mesh;
+			Duplicate.RepresentativeToMesh = GetRepresentativeToMesh(Representative, CanonicalMesh);
+		}
+	}
+	Meshes.Empty();
+}
+
+FTiXInstance FTiXMeshDeduplicator::FoldInstance(const FTiXInstance& Instance, const FTiXMeshDuplicate& Duplicate, float PositionScale)
+{
+	FTiXInstance Result;
+	Result.Transform = Duplicate.RepresentativeToMesh * Instance.Transform;
+	Result.Position = Result.Transform.GetLocation() * PositionScale;
+	Result.Rotation = Result.Transform.GetRotation();
+	Result.Scale = Result.Transform.GetScale3D();
+	return Result;
+}
+
+void FTiXMeshDeduplicator::Canonicalize(FCanonicalMesh& CanonicalMesh)
+{
+	const UStaticMesh* StaticMesh = CanonicalMesh.Mesh;
+	if (StaticMesh == nullptr || StaticMesh->RenderData == nullptr || StaticMesh->RenderData->LODResources.Num() == 0)
+	{
+		return;
+	}
+
+	// LOD0 decides, duplicates are drawn with LODs of the representative mesh
+	const FStaticMeshLODResources& LODResource = StaticMesh->RenderData->LODResources[0];
+	const FPositionVertexBuffer& PositionVertexBuffer = LODResource.VertexBuffers.PositionVertexBuffer;
+	const FStaticMeshVertexBuffer& StaticMeshVertexBuffer = LODResource.VertexBuffers.StaticMeshVertexBuffer;
+	const FColorVertexBuffer& ColorVertexBuffer = LODResource.VertexBuffers.ColorVertexBuffer;
+	const int32 NumVertices = PositionVertexBuffer.GetNumVertices();
+	if (NumVertices < 4)
+	{
+		return;
+	}
+
+	// Centroid
+	double Centroid[3] = { 0.0, 0.0, 0.0 };
+	for (int32 Index = 0; Index < NumVertices; ++Index)
+	{
+		const FVector& Position = PositionVertexBuffer.VertexPosition(Index);
+		Centroid[0] += Position.X;
+		Centroid[1] += Position.Y;
+		Centroid[2] += Position.Z;
+	}
+	for (int32 Axis = 0; Axis < 3; ++Axis)
+	{
+		Centroid[Axis] /= NumVertices;
+	}
+
+	// Covariance
+	double Covariance[3][3] = { {0.0, 0.0, 0.0}, {0.0, 0.0, 0.0}, {0.0, 0.0, 0.0} };
+	for (int32 Index = 0; Index < NumVertices; ++Index)
+	{
+		const FVector& Position = PositionVertexBuffer.VertexPosition(Index);
+		const double D[3] = { Position.X - Centroid[0], Position.Y - Centroid[1], Position.Z - Centroid[2] };
+		for (int32 Row = 0; Row < 3; ++Row)
+		{
+			for (int32 Col = 0; Col < 3; ++Col)
+			{
+				Covariance[Row][Col] += D[Row] * D[Col];
+			}
+		}
+	}
+	for (int32 Row = 0; Row < 3; ++Row)
+	{
+		for (int32 Col = 0; Col < 3; ++Col)
+		{
+			Covariance[Row][Col] /= NumVertices;
+		}
+	}
+
+	// Principal axes, from the largest variance
+	double Values[3], Vectors[3][3];
+	JacobiEigen(Covariance, Values, Vectors);
+	int32 Order[3] = { 0, 1, 2 };
+	Algo::Sort(Order, [&Values](int32 A, int32 B) { return Values[A] > Values[B]; });
+	const double Largest = Values[Order[0]];
+	if (Largest <= 0.0 ||
+		Values[Order[0]] - Values[Order[1]] < AxisEpsilon * Largest ||
+		Values[Order[1]] - Values[Order[2]] < AxisEpsilon * Largest)
+	{
+		// Symmetric in variance, the frame is not unique
+		return;
+	}
+
+	double Axes[3][3];
+	for (int32 Axis = 0; Axis < 2; ++Axis)
+	{
+		for (int32 Row = 0; Row < 3; ++Row)
+		{
+			Axes[Row][Axis] = Vectors[Row][Order[Axis]];
+		}
+
+		// Point axis to the heavier tail
+		double Skew = 0.0;
+		for (int32 Index = 0; Index < NumVertices; ++Index)
+		{
+			const FVector& Position = PositionVertexBuffer.VertexPosition(Index);
+			const double Projection =
+				(Position.X - Centroid[0]) * Axes[0][Axis] +
+				(Position.Y - Centroid[1]) * Axes[1][Axis] +
+				(Position.Z - Centroid[2]) * Axes[2][Axis];
+			Skew += Projection * Projection * Projection;
+		}
+		Skew /= NumVertices;
+		const double Sigma = FMath::Sqrt(Values[Order[Axis]]);
+		if (FMath::Abs(Skew) < SkewEpsilon * Sigma * Sigma * Sigma)
+		{
+			return;
+		}
+		if (Skew < 0.0)
+		{
+			for (int32 Row = 0; Row < 3; ++Row)
+			{
+				Axes[Row][Axis] = -Axes[Row][Axis];
+			}
+		}
+	}
+	// Third axis makes a right handed frame, so the frames differ by a rotation only
+	Axes[0][2] = Axes[1][0] * Axes[2][1] - Axes[2][0] * Axes[1][1];
+	Axes[1][2] = Axes[2][0] * Axes[0][1] - Axes[0][0] * Axes[2][1];
+	Axes[2][2] = Axes[0][0] * Axes[1][1] - Axes[1][0] * Axes[0][1];
+
+	// Canonical positions
+	TArray<FVector> CanonicalPositions;
+	CanonicalPositions.AddUninitialized(NumVertices);
+	double MaxExtent = 0.0;
+	for (int32 Index = 0; Index < NumVertices; ++Index)
+	{
+		const FVector& Position = PositionVertexBuffer.VertexPosition(Index);
+		const double D[3] = { Position.X - Centroid[0], Position.Y - Centroid[1], Position.Z - Centroid[2] };
+		double Canonical[3];
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			Canonical[Axis] = D[0] * Axes[0][Axis] + D[1] * Axes[1][Axis] + D[2] * Axes[2][Axis];
+			MaxExtent = FMath::Max(MaxExtent, FMath::Abs(Canonical[Axis]));
+		}
+		CanonicalPositions[Index] = FVector(Canonical[0], Canonical[1], Canonical[2]);
+	}
+
+	// Quantize with a power of two step, about 1/8192 of mesh extent
+	const double Step = FMath::Pow(2.0, FMath::FloorToDouble(FMath::Log2(MaxExtent)) - 13.0);
+	const int32 NumTexCoords = StaticMeshVertexBuffer.GetNumTexCoords();
+	const bool bHasColor = ColorVertexBuffer.GetNumVertices() > 0;
+	// Position, tangent Z, tangent X, binormal sign, texcoords and color
+	const int32 Stride = 3 + 3 + 3 + 1 + NumTexCoords * 2 + (bHasColor ? 1 : 0);
+	TArray<int32> VertexKeys;
+	VertexKeys.AddUninitialized(NumVertices * Stride);
+	for (int32 Index = 0; Index < NumVertices; ++Index)
+	{
+		int32* Key = VertexKeys.GetData() + Index * Stride;
+		*Key++ = FMath::RoundToInt(CanonicalPositions[Index].X / Step);
+		*Key++ = FMath::RoundToInt(CanonicalPositions[Index].Y / Step);
+		*Key++ = FMath::RoundToInt(CanonicalPositions[Index].Z / Step);
+		// Tangent basis rotates with the mesh, so meshes that only differ in smoothing do not match
+		const FVector4 TangentZ = StaticMeshVertexBuffer.VertexTangentZ(Index);
+		const FVector TangentX = StaticMeshVertexBuffer.VertexTangentX(Index);
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			*Key++ = FMath::RoundToInt((TangentZ.X * Axes[0][Axis] + TangentZ.Y * Axes[1][Axis] + TangentZ.Z * Axes[2][Axis]) * TangentQuantization);
+		}
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			*Key++ = FMath::RoundToInt((TangentX.X * Axes[0][Axis] + TangentX.Y * Axes[1][Axis] + TangentX.Z * Axes[2][Axis]) * TangentQuantization);
+		}
+		*Key++ = TangentZ.W < 0.f ? -1 : 1;
+		for (int32 UVIndex = 0; UVIndex < NumTexCoords; ++UVIndex)
+		{
+			const FVector2D UV = StaticMeshVertexBuffer.GetVertexUV(Index, UVIndex);
+			*Key++ = FMath::RoundToInt(UV.X * UVQuantization);
+			*Key++ = FMath::RoundToInt(UV.Y * UVQuantization);
+		}
+		if (bHasColor)
+		{
+			*Key++ = (int32)ColorVertexBuffer.VertexColor(Index).DWColor();
+		}
+	}
+	auto CompareKeys = [&VertexKeys, Stride](uint32 A, uint32 B)
+	{
+		return FMemory::Memcmp(VertexKeys.GetData() + A * Stride, VertexKeys.GetData() + B * Stride, Stride * sizeof(int32));
+	};
+
+	const FIndexArrayView Indices = LODResource.IndexBuffer.GetArrayView();
+
+	// Sections in order, each with triangles sorted by their corner keys
+	CanonicalMesh.Triangles.Reset();
+	CanonicalMesh.Triangles.Add(Stride);
+	TArray<FIntVector> SectionTriangles;
+	for (const FStaticMeshSection& Section : LODResource.Sections)
+	{
+		CanonicalMesh.Materials.Add(StaticMesh->StaticMaterials.IsValidIndex(Section.MaterialIndex) ? StaticMesh->StaticMaterials[Section.MaterialIndex].MaterialInterface : nullptr);
+		CanonicalMesh.Triangles.Add(Section.NumTriangles);
+
+		// Start each triangle from its smallest corner, keeping the winding
+		SectionTriangles.Reset(Section.NumTriangles);
+		for (uint32 Tri = 0; Tri < Section.NumTriangles; ++Tri)
+		{
+			const uint32 First = Section.FirstIndex + Tri * 3;
+			FIntVector Triangle(Indices[First], Indices[First + 1], Indices[First + 2]);
+			if (CompareKeys(Triangle.Y, Triangle.X) < 0 && CompareKeys(Triangle.Y, Triangle.Z) < 0)
+			{
+				Triangle = FIntVector(Triangle.Y, Triangle.Z, Triangle.X);
+			}
+			else if (CompareKeys(Triangle.Z, Triangle.X) < 0 && CompareKeys(Triangle.Z, Triangle.Y) < 0)
+			{
+				Triangle = FIntVector(Triangle.Z, Triangle.X, Triangle.Y);
+			}
+			SectionTriangles.Add(Triangle);
+		}
+		SectionTriangles.Sort([&CompareKeys](const FIntVector& A, const FIntVector& B)
+		{
+			for (int32 Corner = 0; Corner < 3; ++Corner)
+			{
+				const int32 Result = CompareKeys(A[Corner], B[Corner]);
+				if (Result != 0)
+				{
+					return Result < 0;
+				}
+			}
+			return false;
+		});
+
+		for (const FIntVector& Triangle : SectionTriangles)
+		{
+			for (int32 Corner = 0; Corner < 3; ++Corner)
+			{
+				CanonicalMesh.Triangles.Append(VertexKeys.GetData() + Triangle[Corner] * Stride, Stride);
+			}
+		}
+	}
+
+	uint64 Hash = CityHash64((const char*)CanonicalMesh.Triangles.GetData(), CanonicalMesh.Triangles.Num() * sizeof(int32));
+	for (const UObject* Material : CanonicalMesh.Materials)
+	{
+		Hash = CityHash64WithSeed((const char*)&Material, sizeof(Material), Hash);
+	}
+	CanonicalMesh.Hash = Hash;
+	CanonicalMesh.Centroid = FVector(Centroid[0], Centroid[1], Centroid[2]);
+	FMemory::Memcpy(CanonicalMesh.Axes, Axes, sizeof(Axes));
+	CanonicalMesh.bValid = true;
+}
+
+FTransform FTiXMeshDeduplicator::GetRepresentativeToMesh(const FCanonicalMesh& Representative, const FCanonicalMesh& Mesh)
+{
+	// Both share canonical positions Q: P0 = R0 * Q + C0, P1 = R1 * Q + C1, so P1 = R1 * R0^T * (P0 - C0) + C1
+	double Rotation[3][3];
+	for (int32 Row = 0; Row < 3; ++Row)
+	{
+		for (int32 Col = 0; Col < 3; ++Col)
+		{
+			Rotation[Row][Col] =
+				Mesh.Axes[Row][0] * Representative.Axes[Col][0] +
+				Mesh.Axes[Row][1] * Representative.Axes[Col][1] +
+				Mesh.Axes[Row][2] * Representative.Axes[Col][2];
+		}
+	}
+
+	// FMatrix transforms row vectors, its rows are images of the basis vectors
+	const FMatrix RotationMatrix(
+		FVector(Rotation[0][0], Rotation[1][0], Rotation[2][0]),
+		FVector(Rotation[0][1], Rotation[1][1], Rotation[2][1]),
+		FVector(Rotation[0][2], Rotation[1][2], Rotation[2][2]),
+		FVector::ZeroVector);
+	const FVector Translation = Mesh.Centroid - RotationMatrix.TransformVector(Representative.Centroid);
+	return FTransform(FQuat(RotationMatrix), Translation);
+}
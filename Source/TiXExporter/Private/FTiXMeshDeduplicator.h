@@ -0,0 +1,53 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TiXExporterDefines.h"
+
+class UStaticMesh;
+
+/**
+* Finds static meshes with the same geometry up to a rigid transform.
+* Each mesh is moved into a canonical frame by its centroid and principal axes,
+* then its triangles are quantized, sorted and hashed, with tangent bases rotated into the same frame.
+* The mesh with the smallest path represents each geometry.
+*/
+class FTiXMeshDeduplicator
+{
+public:
+	/** Add a mesh to analyze. Meshes with bCanFold false can be representatives, but never fold into others. */
+	void AddMesh(UStaticMesh* StaticMesh, bool bCanFold);
+
+	/** Canonicalize all added meshes and match them. */
+	void FindDuplicates();
+
+	const TMap<UStaticMesh*, FTiXMeshDuplicate>& GetDuplicates() const
+	{
+		return Duplicates;
+	}
+
+	/** Make an instance of a duplicate mesh an instance of its representative. */
+	static FTiXInstance FoldInstance(const FTiXInstance& Instance, const FTiXMeshDuplicate& Duplicate, float PositionScale);
+
+private:
+	struct FCanonicalMesh
+	{
+		UStaticMesh* Mesh;
+		bool bCanFold;
+		bool bValid;
+		uint64 Hash;
+
+		// Mesh space = Axes * canonical space + Centroid, Axes are columns of a rotation
+		FVector Centroid;
+		double Axes[3][3];
+
+		TArray<const UObject*> Materials;
+		TArray<int32> Triangles;
+	};
+
+	static void Canonicalize(FCanonicalMesh& CanonicalMesh);
+	static FTransform GetRepresentativeToMesh(const FCanonicalMesh& Representative, const FCanonicalMesh& Mesh);
+
+private:
+	TArray<FCanonicalMesh> Meshes;
+	TMap<UStaticMesh*, FTiXMeshDuplicate> Duplicates;
+};
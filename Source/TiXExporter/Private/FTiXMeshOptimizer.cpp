@@ -0,0 +1,351 @@
+
+#include "FTiXMeshOptimizer.h"
+#include "Algo/BinarySearch.h"
+#include "Algo/StableSort.h"
+
+/** Map indices of a section to 0 ~ NumVertices - 1, returns NumVertices. */
+static int32 MakeLocalIndices(const uint32* Indices, int32 NumIndices, TArray<int32>& OutLocalIndices)
+{
+	TArray<uint32> Vertices(Indices, NumIndices);
+	Vertices.Sort();
+	int32 NumVertices = 0;
+	for (int32 i = 0; i < Vertices.Num(); ++i)
+	{
+		if (i == 0 || Vertices[i] != Vertices[NumVertices - 1])
+		{
+			Vertices[NumVertices++] = Vertices[i];
+		}
+	}
+	Vertices.SetNum(NumVertices, false);
+
+	OutLocalIndices.SetNumUninitialized(NumIndices);
+	for (int32 i = 0; i < NumIndices; ++i)
+	{
+		OutLocalIndices[i] = Algo::LowerBound(Vertices, Indices[i]);
+	}
+	return NumVertices;
+}
+
+FTiXVertexCacheStats FTiXMeshOptimizer::CalcVertexCacheStats(const uint32* Indices, int32 NumIndices)
+{
+	FTiXVertexCacheStats Stats;
+	TArray<int32> LocalIndices;
+	Stats.NumVertices = MakeLocalIndices(Indices, NumIndices, LocalIndices);
+	Stats.NumTriangles = NumIndices / 3;
+
+	// A vertex is in the FIFO cache if less than VertexCacheSize misses happened since it was loaded
+	TArray<int32> LoadTime;
+	LoadTime.Init(-VertexCacheSize - 1, Stats.NumVertices);
+	for (int32 Local : LocalIndices)
+	{
+		if (Stats.NumCacheMisses - LoadTime[Local] >= VertexCacheSize)
+		{
+			LoadTime[Local] = Stats.NumCacheMisses++;
+		}
+	}
+	return Stats;
+}
+
+void FTiXMeshOptimizer::OptimizeVertexCache(uint32* Indices, int32 NumIndices)
+{
+	const int32 NumTriangles = NumIndices / 3;
+	if (NumTriangles < 2)
+	{
+		return;
+	}
+	TArray<int32> LocalIndices;
+	const int32 NumVertices = MakeLocalIndices(Indices, NumTriangles * 3, LocalIndices);
+
+	// Triangles adjacent to each vertex
+	TArray<int32> AdjacencyOffsets;
+	AdjacencyOffsets.SetNumZeroed(NumVertices + 1);
+	for (int32 Local : LocalIndices)
+	{
+		++AdjacencyOffsets[Local + 1];
+	}
+	for (int32 Vertex = 0; Vertex < NumVertices; ++Vertex)
+	{
+		AdjacencyOffsets[Vertex + 1] += AdjacencyOffsets[Vertex];
+	}
+	TArray<int32> Adjacency;
+	Adjacency.SetNumUninitialized(NumTriangles * 3);
+	TArray<int32> LiveTriangles;
+	LiveTriangles.SetNumZeroed(NumVertices);
+	for (int32 i = 0; i < NumTriangles * 3; ++i)
+	{
+		const int32 Vertex = LocalIndices[i];
+		Adjacency[AdjacencyOffsets[Vertex] + LiveTriangles[Vertex]++] = i / 3;
+	}
+
+	TArray<int32> CacheTime;
+	CacheTime.SetNumZeroed(NumVertices);
+	TBitArray<> Emitted(false, NumTriangles);
+	TArray<int32> DeadEnd;
+	TArray<int32> Candidates;
+	TArray<uint32> Output;
+	Output.Reserve(NumTriangles * 3);
+
+	int32 Time = VertexCacheSize + 1;
+	int32 Cursor = 0;
+	int32 Fanning = 0;
+	while (Fanning >= 0)
+	{
+		// Emit all remaining triangles around the fanning vertex
+		Candidates.Reset();
+		for (int32 a = AdjacencyOffsets[Fanning]; a < AdjacencyOffsets[Fanning + 1]; ++a)
+		{
+			const int32 Triangle = Adjacency[a];
+			if (Emitted[Triangle])
+			{
+				continue;
+			}
+			for (int32 Corner = 0; Corner < 3; ++Corner)
+			{
+				const int32 Vertex = LocalIndices[Triangle * 3 + Corner];
+				Output.Add(Indices[Triangle * 3 + Corner]);
+				DeadEnd.Add(Vertex);
+				Candidates.Add(Vertex);
+				--LiveTriangles[Vertex];
+				if (Time - CacheTime[Vertex] > VertexCacheSize)
+				{
+					CacheTime[Vertex] = Time++;
+				}
+			}
+			Emitted[Triangle] = true;
+		}
+
+		// Next fanning vertex is the oldest candidate still in cache after its triangles are emitted
+		int32 Next = INDEX_NONE;
+		int32 BestPriority = -1;
+		for (int32 Vertex : Candidates)
+		{
+			if (LiveTriangles[Vertex] > 0)
+			{
+				int32 Priority = 0;
+				if (Time - CacheTime[Vertex] + 2 * LiveTriangles[Vertex] <= VertexCacheSize)
+				{
+					Priority = Time - CacheTime[Vertex];
+				}
+				if (Priority > BestPriority)
+				{
+					BestPriority = Priority;
+					Next = Vertex;
+				}
+			}
+		}
+
+		// Dead end, try recently used vertices, then the next vertex in order
+		while (Next == INDEX_NONE && DeadEnd.Num() > 0)
+		{
+			const int32 Vertex = DeadEnd.Pop(false);
+			if (LiveTriangles[Vertex] > 0)
+			{
+				Next = Vertex;
+			}
+		}
+		while (Next == INDEX_NONE && Cursor < NumVertices)
+		{
+			if (LiveTriangles[Cursor] > 0)
+			{
+				Next = Cursor;
+			}
+			++Cursor;
+		}
+		Fanning = Next;
+	}
+
+	check(Output.Num() == NumTriangles * 3);
+	FMemory::Memcpy(Indices, Output.GetData(), Output.Num() * sizeof(uint32));
+}
+
+/** Count cache misses of a triangle, vertices loaded before CacheStart are treated as evicted. */
+static FORCEINLINE int32 SimulateTriangle(const int32* LocalIndices, TArray<int32>& LoadTime, int32& Time, int32 CacheStart)
+{
+	int32 Misses = 0;
+	for (int32 Corner = 0; Corner < 3; ++Corner)
+	{
+		int32& Loaded = LoadTime[LocalIndices[Corner]];
+		if (Loaded < CacheStart || Time - Loaded >= FTiXMeshOptimizer::VertexCacheSize)
+		{
+			Loaded = Time++;
+			++Misses;
+		}
+	}
+	return Misses;
+}
+
+void FTiXMeshOptimizer::OptimizeOverdraw(uint32* Indices, int32 NumIndices, const TArray<FVector>& Positions, float CacheThreshold)
+{
+	const int32 NumTriangles = NumIndices / 3;
+	if (NumTriangles < 2)
+	{
+		return;
+	}
+	TArray<int32> LocalIndices;
+	const int32 NumVertices = MakeLocalIndices(Indices, NumTriangles * 3, LocalIndices);
+
+	// Hard boundaries, where the cache order restarts with 3 misses
+	TArray<int32> LoadTime;
+	LoadTime.Init(-VertexCacheSize - 1, NumVertices);
+	int32 Time = 0;
+	TArray<int32> HardBoundaries;
+	for (int32 Triangle = 0; Triangle < NumTriangles; ++Triangle)
+	{
+		if (SimulateTriangle(&LocalIndices[Triangle * 3], LoadTime, Time, 0) == 3)
+		{
+			HardBoundaries.Add(Triangle);
+		}
+	}
+	HardBoundaries.Add(NumTriangles);
+
+	// Soft boundaries inside hard clusters, where splitting costs little cache efficiency
+	TArray<int32> Clusters;
+	for (int32 Hard = 0; Hard + 1 < HardBoundaries.Num(); ++Hard)
+	{
+		const int32 Start = HardBoundaries[Hard];
+		const int32 End = HardBoundaries[Hard + 1];
+
+		int32 CacheStart = Time;
+		int32 ClusterMisses = 0;
+		for (int32 Triangle = Start; Triangle < End; ++Triangle)
+		{
+			ClusterMisses += SimulateTriangle(&LocalIndices[Triangle * 3], LoadTime, Time, CacheStart);
+		}
+		const float MissesThreshold = CacheThreshold * ClusterMisses / (End - Start);
+
+		Clusters.Add(Start);
+		CacheStart = Time;
+		int32 Misses = 0;
+		int32 SubStart = Start;
+		for (int32 Triangle = Start; Triangle < End - 1; ++Triangle)
+		{
+			Misses += SimulateTriangle(&LocalIndices[Triangle * 3], LoadTime, Time, CacheStart);
+			if (Misses <= MissesThreshold * (Triangle + 1 - SubStart))
+			{
+				Clusters.Add(Triangle + 1);
+				CacheStart = Time;
+				Misses = 0;
+				SubStart = Triangle + 1;
+			}
+		}
+	}
+	Clusters.Add(NumTriangles);
+
+	// Area weighted centroid and normal of each cluster and the mesh
+	const int32 NumClusters = Clusters.Num() - 1;
+	TArray<FVector> ClusterCentroids, ClusterNormals;
+	ClusterCentroids.SetNumZeroed(NumClusters);
+	ClusterNormals.SetNumZeroed(NumClusters);
+	FVector MeshCentroid = FVector::ZeroVector;
+	float MeshArea = 0.f;
+	for (int32 Cluster = 0; Cluster < NumClusters; ++Cluster)
+	{
+		float ClusterArea = 0.f;
+		for (int32 Triangle = Clusters[Cluster]; Triangle < Clusters[Cluster + 1]; ++Triangle)
+		{
+			const FVector& P0 = Positions[Indices[Triangle * 3 + 0]];
+			const FVector& P1 = Positions[Indices[Triangle * 3 + 1]];
+			const FVector& P2 = Positions[Indices[Triangle * 3 + 2]];
+			const FVector Normal = (P1 - P0) ^ (P2 - P0);
+			const float Area = Normal.Size();
+			ClusterCentroids[Cluster] += (P0 + P1 + P2) * (Area / 3.f);
+			ClusterNormals[Cluster] += Normal;
+			ClusterArea += Area;
+		}
+		MeshCentroid += ClusterCentroids[Cluster];
+		MeshArea += ClusterArea;
+		ClusterCentroids[Cluster] = ClusterArea > 0.f ? ClusterCentroids[Cluster] / ClusterArea : Positions[Indices[Clusters[Cluster] * 3]];
+	}
+	MeshCentroid = MeshArea > 0.f ? MeshCentroid / MeshArea : FVector::ZeroVector;
+
+	// Clusters facing away from the mesh center first
+	TArray<float> SortKeys;
+	TArray<int32> ClusterOrder;
+	SortKeys.SetNumUninitialized(NumClusters);
+	ClusterOrder.SetNumUninitialized(NumClusters);
+	for (int32 Cluster = 0; Cluster < NumClusters; ++Cluster)
+	{
+		SortKeys[Cluster] = (ClusterCentroids[Cluster] - MeshCentroid) | ClusterNormals[Cluster].GetSafeNormal();
+		ClusterOrder[Cluster] = Cluster;
+	}
+	Algo::StableSort(ClusterOrder, [&SortKeys](int32 A, int32 B)
+	{
+		return SortKeys[A] > SortKeys[B];
+	});
+
+	TArray<uint32> Output;
+	Output.Reserve(NumTriangles * 3);
+	for (int32 Cluster : ClusterOrder)
+	{
+		Output.Append(Indices + Clusters[Cluster] * 3, (Clusters[Cluster + 1] - Clusters[Cluster]) * 3);
+	}
+	FMemory::Memcpy(Indices, Output.GetData(), Output.Num() * sizeof(uint32));
+}
+
+void FTiXMeshOptimizer::OptimizeVertexFetch(TArray<uint32>& InOutIndices, FTiXVertexStreams& InOutVertices)
+{
+	// New index of each old vertex, and old vertex of each new index
+	TArray<uint32> Remap;
+	TArray<int32> Order;
+	Remap.Init(MAX_uint32, InOutVertices.Num());
+	Order.Reserve(InOutVertices.Num());
+	for (uint32& Index : InOutIndices)
+	{
+		uint32& NewIndex = Remap[Index];
+		if (NewIndex == MAX_uint32)
+		{
+			NewIndex = Order.Add(Index);
+		}
+		Index = NewIndex;
+	}
+
+	InOutVertices.ForEachStream([&Order](auto& Stream)
+	{
+		const auto OldStream = MoveTemp(Stream);
+		Stream.Reset(Order.Num());
+		for (int32 OldIndex : Order)
+		{
+			Stream.Add(OldStream[OldIndex]);
+		}
+	});
+}
+
+int32 FTiXMeshOptimizer::RemoveDegenerateTriangles(uint32* Indices, int32 NumIndices, const TArray<FVector>& Positions, float AreaThreshold, float AspectThreshold, FTiXDegenerateStats& OutStats)
+{
+	const int32 NumTriangles = NumIndices / 3;
+	int32 NumKept = 0;
+	for (int32 Triangle = 0; Triangle < NumTriangles; ++Triangle)
+	{
+		const uint32 I0 = Indices[Triangle * 3 + 0];
+		const uint32 I1 = Indices[Triangle * 3 + 1];
+		const uint32 I2 = Indices[Triangle * 3 + 2];
+		if (I0 == I1 || I1 == I2 || I2 == I0)
+		{
+			++OutStats.NumDegenerates;
+			continue;
+		}
+
+		const FVector& P0 = Positions[I0];
+		const FVector& P1 = Positions[I1];
+		const FVector& P2 = Positions[I2];
+		// Twice the area, which is also the longest edge times the height on it
+		const float DoubleArea = ((P1 - P0) ^ (P2 - P0)).Size();
+		if (DoubleArea <= AreaThreshold * 2.f)
+		{
+			++OutStats.NumDegenerates;
+			continue;
+		}
+		const float LongestEdgeSquared = FMath::Max3((P1 - P0).SizeSquared(), (P2 - P1).SizeSquared(), (P0 - P2).SizeSquared());
+		if (AspectThreshold > 0.f && LongestEdgeSquared > AspectThreshold * DoubleArea)
+		{
+			++OutStats.NumSlivers;
+			continue;
+		}
+
+		Indices[NumKept * 3 + 0] = I0;
+		Indices[NumKept * 3 + 1] = I1;
+		Indices[NumKept * 3 + 2] = I2;
+		++NumKept;
+	}
+	return NumKept * 3;
+}
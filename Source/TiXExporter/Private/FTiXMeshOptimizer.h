@@ -0,0 +1,94 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TiXExporterDefines.h"
+
+/** Post-transform vertex cache statistics of a triangle list. */
+struct FTiXVertexCacheStats
+{
+	int32 NumTriangles;
+	int32 NumVertices;
+	int32 NumCacheMisses;
+
+	FTiXVertexCacheStats()
+		: NumTriangles(0)
+		, NumVertices(0)
+		, NumCacheMisses(0)
+	{}
+
+	void Accumulate(const FTiXVertexCacheStats& Other)
+	{
+		NumTriangles += Other.NumTriangles;
+		NumVertices += Other.NumVertices;
+		NumCacheMisses += Other.NumCacheMisses;
+	}
+
+	/** Average cache miss ratio, transformed vertices per triangle, 0.5 ~ 3. */
+	float GetACMR() const
+	{
+		return NumTriangles > 0 ? float(NumCacheMisses) / NumTriangles : 0.f;
+	}
+
+	/** Average transform to vertex ratio, 1 is optimal. */
+	float GetATVR() const
+	{
+		return NumVertices > 0 ? float(NumCacheMisses) / NumVertices : 0.f;
+	}
+};
+
+/** Triangles removed from a triangle list by degenerate triangle cleanup. */
+struct FTiXDegenerateStats
+{
+	// Repeated vertices or area up to the area threshold
+	int32 NumDegenerates;
+	// Long and thin, above the aspect threshold
+	int32 NumSlivers;
+
+	FTiXDegenerateStats()
+		: NumDegenerates(0)
+		, NumSlivers(0)
+	{}
+
+	void Accumulate(const FTiXDegenerateStats& Other)
+	{
+		NumDegenerates += Other.NumDegenerates;
+		NumSlivers += Other.NumSlivers;
+	}
+};
+
+/**
+* Reorders triangle lists of mesh sections and vertices of meshes for the GPU.
+* Indices of a section may reference any vertex of the mesh, sections are processed independently.
+*/
+class FTiXMeshOptimizer
+{
+public:
+	// FIFO post-transform cache size used for optimizing and statistics
+	static const int32 VertexCacheSize = 16;
+
+	/** Simulate a FIFO vertex cache over a triangle list. */
+	static FTiXVertexCacheStats CalcVertexCacheStats(const uint32* Indices, int32 NumIndices);
+
+	/** Reorder triangles for vertex cache locality with Tipsify, Sander et al. 2007. */
+	static void OptimizeVertexCache(uint32* Indices, int32 NumIndices);
+
+	/**
+	* Reorder clusters of a vertex cache optimized triangle list to reduce overdraw, Sander et al. 2007.
+	* Clusters split where their ACMR stays within CacheThreshold times of the ACMR around them,
+	* then clusters facing out of the mesh are drawn first, as they occlude others from most views.
+	*/
+	static void OptimizeOverdraw(uint32* Indices, int32 NumIndices, const TArray<FVector>& Positions, float CacheThreshold);
+
+	/**
+	* Renumber vertices in the order indices first use them, so vertex fetches walk all streams linearly.
+	* Runs on the whole mesh after triangles are reordered, unreferenced vertices are removed.
+	*/
+	static void OptimizeVertexFetch(TArray<uint32>& InOutIndices, FTiXVertexStreams& InOutVertices);
+
+	/**
+	* Remove triangles with repeated vertices or an area up to AreaThreshold, and slivers whose longest edge
+	* is more than AspectThreshold times their height on it, 0 keeps slivers.
+	* Remaining triangles keep their order at the front of Indices, returns their number of indices.
+	*/
+	static int32 RemoveDegenerateTriangles(uint32* Indices, int32 NumIndices, const TArray<FVector>& Positions, float AreaThreshold, float AspectThreshold, FTiXDegenerateStats& OutStats);
+};
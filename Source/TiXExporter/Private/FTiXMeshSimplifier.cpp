@@ -0,0 +1,706 @@
+
+#include "FTiXMeshSimplifier.h"
+
+// Attributes are weighted against positions normalized to the mesh radius
+static const float NormalWeight = 0.25f;
+static const float TexCoordWeight = 0.5f;
+// Borders and seams keep their shape stronger than surfaces
+static const double BorderWeight = 10.0;
+// Normal of a triangle may rotate less than 75 degrees in a collapse
+static const float FlipThreshold = 0.25f;
+
+/** Weighted sum of squared linear functions of position, e.g. distances to planes. */
+struct FQuadric
+{
+	double A00, A01, A02, A11, A12, A22;
+	double B0, B1, B2;
+	double C;
+	// Sum of weights of planes
+	double W;
+
+	FQuadric()
+		: A00(0), A01(0), A02(0), A11(0), A12(0), A22(0)
+		, B0(0), B1(0), B2(0)
+		, C(0)
+		, W(0)
+	{}
+
+	/** Add Weight * (G.P + D)^2. */
+	void AddLinear(const FVector& G, double D, double Weight)
+	{
+		A00 += Weight * G.X * G.X;
+		A01 += Weight * G.X * G.Y;
+		A02 += Weight * G.X * G.Z;
+		A11 += Weight * G.Y * G.Y;
+		A12 += Weight * G.Y * G.Z;
+		A22 += Weight * G.Z * G.Z;
+		B0 += Weight * D * G.X;
+		B1 += Weight * D * G.Y;
+		B2 += Weight * D * G.Z;
+		C += Weight * D * D;
+	}
+
+	/** Add squared distance to plane N.P + D = 0, N is normalized. */
+	void AddPlane(const FVector& N, double D, double Weight)
+	{
+		AddLinear(N, D, Weight);
+		W += Weight;
+	}
+
+	void Add(const FQuadric& Other)
+	{
+		A00 += Other.A00;
+		A01 += Other.A01;
+		A02 += Other.A02;
+		A11 += Other.A11;
+		A12 += Other.A12;
+		A22 += Other.A22;
+		B0 += Other.B0;
+		B1 += Other.B1;
+		B2 += Other.B2;
+		C += Other.C;
+		W += Other.W;
+	}
+
+	double Eval(const FVector& P) const
+	{
+		const double X = P.X, Y = P.Y, Z = P.Z;
+		return X * (A00 * X + 2.0 * (A01 * Y + A02 * Z + B0)) + Y * (A11 * Y + 2.0 * (A12 * Z + B1)) + Z * (A22 * Z + 2.0 * B2) + C;
+	}
+};
+
+enum class EVertexKind : uint8
+{
+	Manifold,
+	Border,
+	Seam,
+	Locked,
+};
+
+struct FCollapse
+{
+	// Positions, as their first vertex
+	uint32 From;
+	uint32 To;
+	double Error;
+};
+
+/** Vertices of the collapsed position, and vertices of the target position each one collapses onto. */
+struct FWedgeMap
+{
+	int32 Num;
+	uint32 From[2];
+	uint32 To[2];
+};
+
+/**
+* Vertices at the same position are wedges of the position, split by attributes.
+* Geometry quadrics are per position, attribute quadrics are per wedge.
+*/
+class FSimplifierState
+{
+public:
+	FSimplifierState(const FTiXVertexStreams& Vertices, const TArray<uint32>& Indices, const TArray<FTiXMeshSection>& Sections);
+
+	int32 GetNumTriangles() const
+	{
+		return NumLiveTriangles;
+	}
+
+	/** Cheapest collapse of each position, sorted by error. */
+	void FindCollapses(TArray<FCollapse>& OutCollapses);
+	/** Collapse if still valid, return false if rejected. */
+	bool TryCollapse(const FCollapse& Collapse);
+
+	void GetIndices(const TArray<FTiXMeshSection>& Sections, TArray<uint32>& OutIndices, TArray<FTiXMeshSection>& OutSections) const;
+
+private:
+	void InitKinds(const TArray<FTiXMeshSection>& Sections);
+	void InitQuadrics();
+	void BuildAdjacency();
+	bool MapWedges(uint32 From, uint32 To, FWedgeMap& OutMap) const;
+	double GetError(uint32 From, uint32 To, const FWedgeMap& Map) const;
+	bool HasFlips(uint32 From, uint32 To) const;
+
+	static uint64 GetEdgeKey(uint32 A, uint32 B)
+	{
+		return ((uint64)A << 32) | B;
+	}
+
+private:
+	int32 NumVertices;
+	int32 NumAttributes;
+	// Normalized to the mesh radius
+	TArray<FVector> Positions;
+	// Weighted attributes of each vertex
+	TArray<float> Attributes;
+
+	// First vertex of the position, and next wedge in a ring of wedges
+	TArray<uint32> Reps;
+	TArray<uint32> WedgeNext;
+	TArray<EVertexKind> Kinds;
+
+	TArray<FQuadric> Quadrics;
+	// Position terms of attribute quadrics, and gradient terms of each attribute
+	TArray<FQuadric> AttributeQuadrics;
+	TArray<double> AttributeGradients;
+
+	TArray<uint32> Triangles;
+	TArray<int32> SectionFirstTriangles;
+	TBitArray<> DeadTriangles;
+	int32 NumLiveTriangles;
+
+	// Live triangles of each position, when this pass started
+	TArray<int32> AdjacencyOffsets;
+	TArray<int32> Adjacency;
+	TBitArray<> Touched;
+};
+
+FSimplifierState::FSimplifierState(const FTiXVertexStreams& Vertices, const TArray<uint32>& Indices, const TArray<FTiXMeshSection>& Sections)
+	: NumVertices(Vertices.Num())
+	, NumAttributes(0)
+	, NumLiveTriangles(0)
+{
+	// Errors are relative to mesh radius
+	const FBox Bounds(Vertices.Positions);
+	const FVector Center = Bounds.GetCenter();
+	const float Radius = Bounds.GetExtent().GetMax();
+	const float InvRadius = Radius > 0.f ? 1.f / Radius : 1.f;
+	Positions.SetNumUninitialized(NumVertices);
+	for (int32 Vertex = 0; Vertex < NumVertices; ++Vertex)
+	{
+		Positions[Vertex] = (Vertices.Positions[Vertex] - Center) * InvRadius;
+	}
+
+	const bool bHasNormals = (Vertices.VsFormat & EVSSEG_NORMAL) != 0;
+	const bool bHasTexCoords = (Vertices.VsFormat & EVSSEG_TEXCOORD0) != 0;
+	NumAttributes = (bHasNormals ? 3 : 0) + (bHasTexCoords ? 2 : 0);
+	Attributes.Reserve(NumVertices * NumAttributes);
+	for (int32 Vertex = 0; Vertex < NumVertices; ++Vertex)
+	{
+		if (bHasNormals)
+		{
+			const FVector Normal = Vertices.Normals[Vertex] * NormalWeight;
+			Attributes.Append(&Normal.X, 3);
+		}
+		if (bHasTexCoords)
+		{
+			const FVector2D TexCoord = Vertices.TexCoords[0][Vertex] * TexCoordWeight;
+			Attributes.Append(&TexCoord.X, 2);
+		}
+	}
+
+	// Wedges of each position
+	TMap<FVector, uint32> PositionReps;
+	PositionReps.Reserve(NumVertices);
+	Reps.SetNumUninitialized(NumVertices);
+	WedgeNext.SetNumUninitialized(NumVertices);
+	for (int32 Vertex = 0; Vertex < NumVertices; ++Vertex)
+	{
+		const uint32* Found = PositionReps.Find(Vertices.Positions[Vertex]);
+		const uint32 Rep = Found != nullptr ? *Found : PositionReps.Add(Vertices.Positions[Vertex], Vertex);
+		Reps[Vertex] = Rep;
+		WedgeNext[Vertex] = Vertex;
+		if (Rep != (uint32)Vertex)
+		{
+			WedgeNext[Vertex] = WedgeNext[Rep];
+			WedgeNext[Rep] = Vertex;
+		}
+	}
+
+	// Triangles with repeated positions can not collapse consistently, they are dropped
+	Triangles.Reserve(Indices.Num());
+	for (const FTiXMeshSection& TiXSection : Sections)
+	{
+		SectionFirstTriangles.Add(Triangles.Num() / 3);
+		const uint32 MaxIndex = TiXSection.IndexStart + TiXSection.NumTriangles * 3;
+		for (uint32 ii = TiXSection.IndexStart; ii < MaxIndex; ii += 3)
+		{
+			const uint32 R0 = Reps[Indices[ii]], R1 = Reps[Indices[ii + 1]], R2 = Reps[Indices[ii + 2]];
+			if (R0 != R1 && R1 != R2 && R2 != R0)
+			{
+				Triangles.Append(&Indices[ii], 3);
+			}
+		}
+	}
+	SectionFirstTriangles.Add(Triangles.Num() / 3);
+	NumLiveTriangles = Triangles.Num() / 3;
+	DeadTriangles.Init(false, NumLiveTriangles);
+
+	InitKinds(Sections);
+	InitQuadrics();
+}
+
+void FSimplifierState::InitKinds(const TArray<FTiXMeshSection>& Sections)
+{
+	TMap<uint64, int32> PositionEdges;
+	TSet<uint64> WedgeEdges;
+	PositionEdges.Reserve(Triangles.Num());
+	WedgeEdges.Reserve(Triangles.Num());
+	for (int32 Corner = 0; Corner < Triangles.Num(); ++Corner)
+	{
+		const uint32 A = Triangles[Corner];
+		const uint32 B = Triangles[Corner % 3 == 2 ? Corner - 2 : Corner + 1];
+		++PositionEdges.FindOrAdd(GetEdgeKey(Reps[A], Reps[B]));
+		WedgeEdges.Add(GetEdgeKey(A, B));
+	}
+
+	// Border edges have no opposite edge, of positions or of wedges
+	TArray<int32> BorderOut, BorderIn, WedgeBorderOut, WedgeBorderIn;
+	TBitArray<> NonManifold(false, NumVertices);
+	BorderOut.SetNumZeroed(NumVertices);
+	BorderIn.SetNumZeroed(NumVertices);
+	WedgeBorderOut.SetNumZeroed(NumVertices);
+	WedgeBorderIn.SetNumZeroed(NumVertices);
+	for (const auto& Edge : PositionEdges)
+	{
+		const uint32 A = (uint32)(Edge.Key >> 32), B = (uint32)Edge.Key;
+		if (Edge.Value > 1)
+		{
+			NonManifold[A] = true;
+			NonManifold[B] = true;
+		}
+		if (!PositionEdges.Contains(GetEdgeKey(B, A)))
+		{
+			++BorderOut[A];
+			++BorderIn[B];
+		}
+	}
+	for (uint64 Edge : WedgeEdges)
+	{
+		const uint32 A = (uint32)(Edge >> 32), B = (uint32)Edge;
+		if (!WedgeEdges.Contains(GetEdgeKey(B, A)))
+		{
+			++WedgeBorderOut[A];
+			++WedgeBorderIn[B];
+		}
+	}
+
+	// Positions between sections are locked, materials meet there
+	TArray<int32> PositionSections;
+	PositionSections.Init(INDEX_NONE, NumVertices);
+	for (int32 Section = 0; Section + 1 < SectionFirstTriangles.Num(); ++Section)
+	{
+		for (int32 Corner = SectionFirstTriangles[Section] * 3; Corner < SectionFirstTriangles[Section + 1] * 3; ++Corner)
+		{
+			int32& PositionSection = PositionSections[Reps[Triangles[Corner]]];
+			PositionSection = (PositionSection == INDEX_NONE || PositionSection == Section) ? Section : MAX_int32;
+		}
+	}
+
+	Kinds.Init(EVertexKind::Locked, NumVertices);
+	for (uint32 Vertex = 0; Vertex < (uint32)NumVertices; ++Vertex)
+	{
+		if (Reps[Vertex] != Vertex || PositionSections[Vertex] == INDEX_NONE || PositionSections[Vertex] == MAX_int32 || NonManifold[Vertex])
+		{
+			continue;
+		}
+		const uint32 Wedge = WedgeNext[Vertex];
+		const bool bPositionBorder = BorderOut[Vertex] != 0 || BorderIn[Vertex] != 0;
+		if (Wedge == Vertex)
+		{
+			if (!bPositionBorder)
+			{
+				Kinds[Vertex] = EVertexKind::Manifold;
+			}
+			else if (BorderOut[Vertex] == 1 && BorderIn[Vertex] == 1)
+			{
+				Kinds[Vertex] = EVertexKind::Border;
+			}
+		}
+		else if (WedgeNext[Wedge] == Vertex && !bPositionBorder &&
+			WedgeBorderOut[Vertex] == 1 && WedgeBorderIn[Vertex] == 1 && WedgeBorderOut[Wedge] == 1 && WedgeBorderIn[Wedge] == 1)
+		{
+			// Two wedges split by a seam line through this position
+			Kinds[Vertex] = EVertexKind::Seam;
+		}
+	}
+}
+
+void FSimplifierState::InitQuadrics()
+{
+	TSet<uint64> WedgeEdges;
+	WedgeEdges.Reserve(Triangles.Num());
+	for (int32 Corner = 0; Corner < Triangles.Num(); ++Corner)
+	{
+		WedgeEdges.Add(GetEdgeKey(Triangles[Corner], Triangles[Corner % 3 == 2 ? Corner - 2 : Corner + 1]));
+	}
+
+	Quadrics.SetNum(NumVertices);
+	AttributeQuadrics.SetNum(NumAttributes > 0 ? NumVertices : 0);
+	AttributeGradients.SetNumZeroed(NumVertices * NumAttributes * 4);
+	for (int32 Triangle = 0; Triangle < Triangles.Num() / 3; ++Triangle)
+	{
+		const uint32* Corners = &Triangles[Triangle * 3];
+		const FVector& P0 = Positions[Corners[0]];
+		const FVector E1 = Positions[Corners[1]] - P0;
+		const FVector E2 = Positions[Corners[2]] - P0;
+		const FVector N = E1 ^ E2;
+		const float Length = N.Size();
+		if (Length <= 0.f)
+		{
+			continue;
+		}
+		const float Area = Length * 0.5f;
+		const FVector Normal = N / Length;
+
+		// Distance to the triangle plane
+		for (int32 Corner = 0; Corner < 3; ++Corner)
+		{
+			Quadrics[Reps[Corners[Corner]]].AddPlane(Normal, -(Normal | P0), Area);
+		}
+
+		// Distance to planes through borders and seams, perpendicular to the triangle
+		for (int32 Corner = 0; Corner < 3; ++Corner)
+		{
+			const uint32 A = Corners[Corner], B = Corners[(Corner + 1) % 3];
+			if (!WedgeEdges.Contains(GetEdgeKey(B, A)))
+			{
+				const FVector Edge = Positions[B] - Positions[A];
+				const FVector EdgeNormal = (Edge ^ Normal).GetSafeNormal();
+				const double Weight = Edge.SizeSquared() * BorderWeight;
+				Quadrics[Reps[A]].AddPlane(EdgeNormal, -(EdgeNormal | Positions[A]), Weight);
+				Quadrics[Reps[B]].AddPlane(EdgeNormal, -(EdgeNormal | Positions[A]), Weight);
+			}
+		}
+
+		// Deviation of each attribute from its linear interpolation over the triangle
+		if (NumAttributes > 0)
+		{
+			const float InvLengthSquared = 1.f / (Length * Length);
+			const FVector Axis1 = (E2 ^ N) * InvLengthSquared;
+			const FVector Axis2 = (N ^ E1) * InvLengthSquared;
+			for (int32 Corner = 0; Corner < 3; ++Corner)
+			{
+				AttributeQuadrics[Corners[Corner]].W += Area;
+			}
+			for (int32 Attribute = 0; Attribute < NumAttributes; ++Attribute)
+			{
+				const float A0 = Attributes[Corners[0] * NumAttributes + Attribute];
+				const float A1 = Attributes[Corners[1] * NumAttributes + Attribute];
+				const float A2 = Attributes[Corners[2] * NumAttributes + Attribute];
+				const FVector Gradient = Axis1 * (A1 - A0) + Axis2 * (A2 - A0);
+				const double D = A0 - (Gradient | P0);
+				for (int32 Corner = 0; Corner < 3; ++Corner)
+				{
+					AttributeQuadrics[Corners[Corner]].AddLinear(Gradient, D, Area);
+					double* GD = &AttributeGradients[(Corners[Corner] * NumAttributes + Attribute) * 4];
+					GD[0] -= Area * Gradient.X;
+					GD[1] -= Area * Gradient.Y;
+					GD[2] -= Area * Gradient.Z;
+					GD[3] -= Area * D;
+				}
+			}
+		}
+	}
+}
+
+void FSimplifierState::BuildAdjacency()
+{
+	AdjacencyOffsets.Reset();
+	AdjacencyOffsets.AddZeroed(NumVertices + 1);
+	for (int32 Corner = 0; Corner < Triangles.Num(); ++Corner)
+	{
+		if (!DeadTriangles[Corner / 3])
+		{
+			++AdjacencyOffsets[Reps[Triangles[Corner]] + 1];
+		}
+	}
+	for (int32 Vertex = 0; Vertex < NumVertices; ++Vertex)
+	{
+		AdjacencyOffsets[Vertex + 1] += AdjacencyOffsets[Vertex];
+	}
+	TArray<int32> Counts;
+	Counts.SetNumZeroed(NumVertices);
+	Adjacency.SetNumUninitialized(AdjacencyOffsets[NumVertices]);
+	for (int32 Corner = 0; Corner < Triangles.Num(); ++Corner)
+	{
+		if (!DeadTriangles[Corner / 3])
+		{
+			const uint32 Rep = Reps[Triangles[Corner]];
+			Adjacency[AdjacencyOffsets[Rep] + Counts[Rep]++] = Corner / 3;
+		}
+	}
+}
+
+bool FSimplifierState::MapWedges(uint32 From, uint32 To, FWedgeMap& OutMap) const
+{
+	// Each wedge of From collapses onto the wedge of To it shares triangles with
+	OutMap.Num = 0;
+	int32 EdgeTriangles = 0;
+	for (int32 a = AdjacencyOffsets[From]; a < AdjacencyOffsets[From + 1]; ++a)
+	{
+		const int32 Triangle = Adjacency[a];
+		if (DeadTriangles[Triangle])
+		{
+			continue;
+		}
+		const uint32* Corners = &Triangles[Triangle * 3];
+		int32 FromCorner = INDEX_NONE, ToCorner = INDEX_NONE;
+		for (int32 Corner = 0; Corner < 3; ++Corner)
+		{
+			const uint32 Rep = Reps[Corners[Corner]];
+			FromCorner = Rep == From ? Corner : FromCorner;
+			ToCorner = Rep == To ? Corner : ToCorner;
+		}
+		if (FromCorner == INDEX_NONE || ToCorner == INDEX_NONE)
+		{
+			continue;
+		}
+		++EdgeTriangles;
+
+		const uint32 FromWedge = Corners[FromCorner], ToWedge = Corners[ToCorner];
+		int32 Index = 0;
+		while (Index < OutMap.Num && OutMap.From[Index] != FromWedge)
+		{
+			++Index;
+		}
+		if (Index == OutMap.Num)
+		{
+			if (OutMap.Num == (int32)UE_ARRAY_COUNT(OutMap.From))
+			{
+				return false;
+			}
+			OutMap.From[OutMap.Num] = FromWedge;
+			OutMap.To[OutMap.Num++] = ToWedge;
+		}
+		else if (OutMap.To[Index] != ToWedge)
+		{
+			return false;
+		}
+	}
+
+	int32 NumWedges = 0;
+	uint32 Wedge = From;
+	do
+	{
+		++NumWedges;
+		Wedge = WedgeNext[Wedge];
+	} while (Wedge != From);
+	if (NumWedges != OutMap.Num)
+	{
+		return false;
+	}
+
+	// Borders collapse along border edges, seams along seam edges
+	switch (Kinds[From])
+	{
+	case EVertexKind::Border:
+		return EdgeTriangles == 1;
+	case EVertexKind::Seam:
+		return EdgeTriangles == 2;
+	case EVertexKind::Manifold:
+		return EdgeTriangles > 0;
+	default:
+		return false;
+	}
+}
+
+double FSimplifierState::GetError(uint32 From, uint32 To, const FWedgeMap& Map) const
+{
+	const FVector& Target = Positions[To];
+	double Error = Quadrics[From].Eval(Target);
+	for (int32 Index = 0; Index < Map.Num && NumAttributes > 0; ++Index)
+	{
+		const uint32 Wedge = Map.From[Index];
+		const FQuadric& AttributeQuadric = AttributeQuadrics[Wedge];
+		const float* Values = &Attributes[Map.To[Index] * NumAttributes];
+		Error += AttributeQuadric.Eval(Target);
+		for (int32 Attribute = 0; Attribute < NumAttributes; ++Attribute)
+		{
+			const double* GD = &AttributeGradients[(Wedge * NumAttributes + Attribute) * 4];
+			const double Value = Values[Attribute];
+			Error += Value * Value * AttributeQuadric.W + 2.0 * Value * (GD[0] * Target.X + GD[1] * Target.Y + GD[2] * Target.Z + GD[3]);
+		}
+	}
+	// Mean squared error over the area around From
+	const double Weight = Quadrics[From].W;
+	return Weight > 0.0 ? FMath::Max(Error, 0.0) / Weight : 0.0;
+}
+
+bool FSimplifierState::HasFlips(uint32 From, uint32 To) const
+{
+	for (int32 a = AdjacencyOffsets[From]; a < AdjacencyOffsets[From + 1]; ++a)
+	{
+		const int32 Triangle = Adjacency[a];
+		if (DeadTriangles[Triangle])
+		{
+			continue;
+		}
+		const uint32* Corners = &Triangles[Triangle * 3];
+		FVector Before[3], After[3];
+		bool bRemoved = false;
+		for (int32 Corner = 0; Corner < 3; ++Corner)
+		{
+			const uint32 Rep = Reps[Corners[Corner]];
+			bRemoved |= Rep == To;
+			Before[Corner] = Positions[Corners[Corner]];
+			After[Corner] = Rep == From ? Positions[To] : Before[Corner];
+		}
+		if (bRemoved)
+		{
+			continue;
+		}
+		const FVector NormalBefore = (Before[1] - Before[0]) ^ (Before[2] - Before[0]);
+		const FVector NormalAfter = (After[1] - After[0]) ^ (After[2] - After[0]);
+		const float SizeBefore = NormalBefore.Size();
+		if (SizeBefore > 0.f && (NormalBefore | NormalAfter) <= FlipThreshold * SizeBefore * NormalAfter.Size())
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void FSimplifierState::FindCollapses(TArray<FCollapse>& OutCollapses)
+{
+	BuildAdjacency();
+	Touched.Init(false, NumVertices);
+
+	OutCollapses.Reset();
+	for (int32 From = 0; From < NumVertices; ++From)
+	{
+		if (Kinds[From] == EVertexKind::Locked)
+		{
+			continue;
+		}
+		FCollapse Best = { (uint32)From, 0, DBL_MAX };
+		for (int32 a = AdjacencyOffsets[From]; a < AdjacencyOffsets[From + 1]; ++a)
+		{
+			const uint32* Corners = &Triangles[Adjacency[a] * 3];
+			for (int32 Corner = 0; Corner < 3; ++Corner)
+			{
+				const uint32 To = Reps[Corners[Corner]];
+				FWedgeMap Map;
+				if (To != (uint32)From && MapWedges(From, To, Map))
+				{
+					const double Error = GetError(From, To, Map);
+					if (Error < Best.Error)
+					{
+						Best.To = To;
+						Best.Error = Error;
+					}
+				}
+			}
+		}
+		if (Best.Error < DBL_MAX)
+		{
+			OutCollapses.Add(Best);
+		}
+	}
+	OutCollapses.Sort([](const FCollapse& A, const FCollapse& B)
+	{
+		return A.Error < B.Error;
+	});
+}
+
+bool FSimplifierState::TryCollapse(const FCollapse& Collapse)
+{
+	// Positions changed in this pass have stale adjacency
+	const uint32 From = Collapse.From, To = Collapse.To;
+	FWedgeMap Map;
+	if (Touched[From] || Touched[To] || !MapWedges(From, To, Map) || HasFlips(From, To))
+	{
+		return false;
+	}
+
+	for (int32 a = AdjacencyOffsets[From]; a < AdjacencyOffsets[From + 1]; ++a)
+	{
+		const int32 Triangle = Adjacency[a];
+		if (DeadTriangles[Triangle])
+		{
+			continue;
+		}
+		uint32* Corners = &Triangles[Triangle * 3];
+		if (Reps[Corners[0]] == To || Reps[Corners[1]] == To || Reps[Corners[2]] == To)
+		{
+			DeadTriangles[Triangle] = true;
+			--NumLiveTriangles;
+			continue;
+		}
+		for (int32 Corner = 0; Corner < 3; ++Corner)
+		{
+			for (int32 Index = 0; Index < Map.Num; ++Index)
+			{
+				if (Corners[Corner] == Map.From[Index])
+				{
+					Corners[Corner] = Map.To[Index];
+					break;
+				}
+			}
+		}
+	}
+
+	Quadrics[To].Add(Quadrics[From]);
+	for (int32 Index = 0; Index < Map.Num && NumAttributes > 0; ++Index)
+	{
+		AttributeQuadrics[Map.To[Index]].Add(AttributeQuadrics[Map.From[Index]]);
+		for (int32 i = 0; i < NumAttributes * 4; ++i)
+		{
+			AttributeGradients[Map.To[Index] * NumAttributes * 4 + i] += AttributeGradients[Map.From[Index] * NumAttributes * 4 + i];
+		}
+	}
+	Touched[From] = true;
+	Touched[To] = true;
+	return true;
+}
+
+void FSimplifierState::GetIndices(const TArray<FTiXMeshSection>& Sections, TArray<uint32>& OutIndices, TArray<FTiXMeshSection>& OutSections) const
+{
+	OutIndices.Reset(NumLiveTriangles * 3);
+	OutSections = Sections;
+	for (int32 Section = 0; Section < Sections.Num(); ++Section)
+	{
+		FTiXMeshSection& TiXSection = OutSections[Section];
+		TiXSection.IndexStart = OutIndices.Num();
+		for (int32 Triangle = SectionFirstTriangles[Section]; Triangle < SectionFirstTriangles[Section + 1]; ++Triangle)
+		{
+			if (!DeadTriangles[Triangle])
+			{
+				OutIndices.Append(&Triangles[Triangle * 3], 3);
+			}
+		}
+		TiXSection.NumTriangles = (OutIndices.Num() - TiXSection.IndexStart) / 3;
+	}
+}
+
+float FTiXMeshSimplifier::Simplify(const FTiXVertexStreams& Vertices, const TArray<uint32>& Indices, const TArray<FTiXMeshSection>& Sections,
+	int32 TargetTriangles, float TargetError, TArray<uint32>& OutIndices, TArray<FTiXMeshSection>& OutSections)
+{
+	FSimplifierState State(Vertices, Indices, Sections);
+	const double ErrorLimit = TargetError > 0.f ? (double)TargetError * TargetError : DBL_MAX;
+	double MaxError = 0.0;
+
+	// Each pass collapses the cheapest edges not sharing positions, until nothing collapses
+	TArray<FCollapse> Collapses;
+	while (State.GetNumTriangles() > TargetTriangles)
+	{
+		State.FindCollapses(Collapses);
+
+		// A collapse removes 2 triangles. Collapses blocked by earlier ones in this pass are tried again in the next pass,
+		// more expensive collapses wait for them too, once enough triangles are removed.
+		const int32 TriangleGoal = State.GetNumTriangles() - TargetTriangles;
+		const int32 CollapseGoal = TriangleGoal / 2;
+		const double ErrorGoal = CollapseGoal < Collapses.Num() ? 1.5 * Collapses[CollapseGoal].Error : DBL_MAX;
+		const int32 NumTrianglesBefore = State.GetNumTriangles();
+		for (const FCollapse& Collapse : Collapses)
+		{
+			const int32 Removed = NumTrianglesBefore - State.GetNumTriangles();
+			if (Collapse.Error > ErrorLimit || Removed >= TriangleGoal || (Collapse.Error > ErrorGoal && Removed > TriangleGoal / 10))
+			{
+				break;
+			}
+			if (State.TryCollapse(Collapse))
+			{
+				MaxError = FMath::Max(MaxError, Collapse.Error);
+			}
+		}
+		if (State.GetNumTriangles() == NumTrianglesBefore)
+		{
+			break;
+		}
+	}
+
+	State.GetIndices(Sections, OutIndices, OutSections);
+	return (float)FMath::Sqrt(MaxError);
+}
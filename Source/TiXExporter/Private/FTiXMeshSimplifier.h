@@ -0,0 +1,22 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TiXExporterDefines.h"
+
+/**
+* Quadric error mesh simplification, Garland and Heckbert 1997, with attribute quadrics of normals and UV0, Hoppe 1999.
+* Vertices collapse onto neighbor vertices, so no vertex data is created.
+* Open borders and UV seams only collapse along themselves, vertices shared by sections or on complex edges are locked.
+* Thread safe, meshes can be simplified in parallel.
+*/
+class FTiXMeshSimplifier
+{
+public:
+	/**
+	* Collapse edges with the lowest error until TargetTriangles remain, or the next collapse exceeds TargetError.
+	* Errors are relative to the mesh radius, TargetError <= 0 does not limit the error.
+	* OutSections match Sections one to one, unused vertices are kept. Returns the largest error of collapses.
+	*/
+	static float Simplify(const FTiXVertexStreams& Vertices, const TArray<uint32>& Indices, const TArray<FTiXMeshSection>& Sections,
+		int32 TargetTriangles, float TargetError, TArray<uint32>& OutIndices, TArray<FTiXMeshSection>& OutSections);
+};
@@ -0,0 +1,253 @@
+
+#include "FTiXTextureDeduplicator.h"
+#include "Engine/Texture2D.h"
+#include "Hash/CityHash.h"
+#include "TiXExporterBPLibrary.h"
+
+// Mean channel difference of similar images, in 0 ~ 255
+static const float SimilarMeanError = 1.5f;
+// Most pixels of similar images differ no more than this in each channel
+static const int32 SimilarPixelError = 6;
+static const float SimilarPixelRatio = 0.99f;
+
+void FTiXTextureDeduplicator::AddTexture(UTexture2D* Texture)
+{
+	Textures.AddUnique(Texture);
+}
+
+bool FTiXTextureDeduplicator::ReadSourcePixels(UTexture2D* Texture, TArray<FColor>& OutPixels, int32& OutSizeX, int32& OutSizeY)
+{
+	FTextureSource& Source = Texture->Source;
+	if (!Source.IsValid() || Source.GetNumSlices() != 1)
+	{
+		return false;
+	}
+	const ETextureSourceFormat Format = Source.GetFormat();
+	if (Format != TSF_BGRA8 && Format != TSF_G8)
+	{
+		return false;
+	}
+
+	TArray64<uint8> MipData;
+	if (!Source.GetMipData(MipData, 0))
+	{
+		return false;
+	}
+	OutSizeX = Source.GetSizeX();
+	OutSizeY = Source.GetSizeY();
+	const int32 NumPixels = OutSizeX * OutSizeY;
+	OutPixels.SetNumUninitialized(NumPixels);
+	if (Format == TSF_BGRA8)
+	{
+		check(MipData.Num() == NumPixels * sizeof(FColor));
+		FMemory::Memcpy(OutPixels.GetData(), MipData.GetData(), NumPixels * sizeof(FColor));
+	}
+	else
+	{
+		check(MipData.Num() == NumPixels);
+		for (int32 Index = 0; Index < NumPixels; ++Index)
+		{
+			const uint8 Gray = MipData[Index];
+			OutPixels[Index] = FColor(Gray, Gray, Gray, 255);
+		}
+	}
+	return true;
+}
+
+void FTiXTextureDeduplicator::DownsampleHalf(TArray<FColor>& Pixels, int32& SizeX, int32& SizeY)
+{
+	// 2x2 box filter, like the default mip generation
+	const int32 HalfX = FMath::Max(SizeX / 2, 1);
+	const int32 HalfY = FMath::Max(SizeY / 2, 1);
+	TArray<FColor> Result;
+	Result.SetNumUninitialized(HalfX * HalfY);
+	for (int32 Y = 0; Y < HalfY; ++Y)
+	{
+		const int32 Y0 = FMath::Min(Y * 2, SizeY - 1);
+		const int32 Y1 = FMath::Min(Y * 2 + 1, SizeY - 1);
+		for (int32 X = 0; X < HalfX; ++X)
+		{
+			const int32 X0 = FMath::Min(X * 2, SizeX - 1);
+			const int32 X1 = FMath::Min(X * 2 + 1, SizeX - 1);
+			const FColor& C00 = Pixels[Y0 * SizeX + X0];
+			const FColor& C01 = Pixels[Y0 * SizeX + X1];
+			const FColor& C10 = Pixels[Y1 * SizeX + X0];
+			const FColor& C11 = Pixels[Y1 * SizeX + X1];
+			Result[Y * HalfX + X] = FColor(
+				(C00.R + C01.R + C10.R + C11.R + 2) / 4,
+				(C00.G + C01.G + C10.G + C11.G + 2) / 4,
+				(C00.B + C01.B + C10.B + C11.B + 2) / 4,
+				(C00.A + C01.A + C10.A + C11.A + 2) / 4);
+		}
+	}
+	Pixels = MoveTemp(Result);
+	SizeX = HalfX;
+	SizeY = HalfY;
+}
+
+uint64 FTiXTextureDeduplicator::GetThumbnail(const TArray<FColor>& Pixels, int32 SizeX, int32 SizeY)
+{
+	// Average luminance of 8x8 cells, independent of resolution
+	float Cells[64] = { 0.f };
+	int32 CellPixels[64] = { 0 };
+	for (int32 Y = 0; Y < SizeY; ++Y)
+	{
+		const int32 CellY = Y * 8 / SizeY;
+		for (int32 X = 0; X < SizeX; ++X)
+		{
+			const int32 Cell = CellY * 8 + X * 8 / SizeX;
+			const FColor& C = Pixels[Y * SizeX + X];
+			Cells[Cell] += C.R * 0.299f + C.G * 0.587f + C.B * 0.114f;
+			++CellPixels[Cell];
+		}
+	}
+
+	float Average = 0.f;
+	int32 NumCells = 0;
+	for (int32 Cell = 0; Cell < 64; ++Cell)
+	{
+		if (CellPixels[Cell] > 0)
+		{
+			Cells[Cell] /= CellPixels[Cell];
+			Average += Cells[Cell];
+			++NumCells;
+		}
+	}
+	Average /= FMath::Max(NumCells, 1);
+
+	uint64 Thumbnail = 0;
+	for (int32 Cell = 0; Cell < 64; ++Cell)
+	{
+		if (CellPixels[Cell] > 0 && Cells[Cell] > Average)
+		{
+			Thumbnail |= 1ull << Cell;
+		}
+	}
+	return Thumbnail;
+}
+
+bool FTiXTextureDeduplicator::IsSimilar(const TArray<FColor>& A, const TArray<FColor>& B)
+{
+	if (A.Num() != B.Num() || A.Num() == 0)
+	{
+		return false;
+	}
+
+	int64 TotalError = 0;
+	int32 SimilarPixels = 0;
+	for (int32 Index = 0; Index < A.Num(); ++Index)
+	{
+		const int32 ErrorR = FMath::Abs(A[Index].R - B[Index].R);
+		const int32 ErrorG = FMath::Abs(A[Index].G - B[Index].G);
+		const int32 ErrorB = FMath::Abs(A[Index].B - B[Index].B);
+		const int32 ErrorA = FMath::Abs(A[Index].A - B[Index].A);
+		TotalError += ErrorR + ErrorG + ErrorB + ErrorA;
+		if (FMath::Max(FMath::Max(ErrorR, ErrorG), FMath::Max(ErrorB, ErrorA)) <= SimilarPixelError)
+		{
+			++SimilarPixels;
+		}
+	}
+	return float(TotalError) / (A.Num() * 4) <= SimilarMeanError && SimilarPixels >= A.Num() * SimilarPixelRatio;
+}
+
+int32 FTiXTextureDeduplicator::MatchMip(const FTextureSignature& Representative, const FTextureSignature& Texture)
+{
+	// Only power of two scales can be a mip
+	int32 Mip = 0;
+	while ((Texture.SizeX << Mip) < Representative.SizeX && (Texture.SizeY << Mip) < Representative.SizeY)
+	{
+		++Mip;
+	}
+	if ((Texture.SizeX << Mip) != Representative.SizeX || (Texture.SizeY << Mip) != Representative.SizeY)
+	{
+		return INDEX_NONE;
+	}
+	if (Mip > 0 && (Representative.Texture->MipGenSettings == TMGS_NoMipmaps || Mip >= Representative.Texture->GetNumMips()))
+	{
+		return INDEX_NONE;
+	}
+	if (Mip == 0)
+	{
+		// Compression settings never change source pixels, same size copies are exact
+		return Representative.ContentHash == Texture.ContentHash ? 0 : INDEX_NONE;
+	}
+
+	TArray<FColor> RepresentativePixels, TexturePixels;
+	int32 SizeX, SizeY, TextureSizeX, TextureSizeY;
+	if (!ReadSourcePixels(Representative.Texture, RepresentativePixels, SizeX, SizeY) ||
+		!ReadSourcePixels(Texture.Texture, TexturePixels, TextureSizeX, TextureSizeY))
+	{
+		return INDEX_NONE;
+	}
+	for (int32 Level = 0; Level < Mip; ++Level)
+	{
+		DownsampleHalf(RepresentativePixels, SizeX, SizeY);
+	}
+	return IsSimilar(RepresentativePixels, TexturePixels) ? Mip : INDEX_NONE;
+}
+
+void FTiXTextureDeduplicator::FindDuplicates()
+{
+	check(IsInGameThread());
+
+	// Signatures, source pixels are released right after
+	TArray<FTextureSignature> Signatures;
+	Signatures.Reserve(Textures.Num());
+	TArray<FColor> Pixels;
+	for (UTexture2D* Texture : Textures)
+	{
+		FTextureSignature Signature;
+		if (!ReadSourcePixels(Texture, Pixels, Signature.SizeX, Signature.SizeY))
+		{
+			continue;
+		}
+		Signature.Texture = Texture;
+		Signature.SettingsKey = GetTypeHash(Texture->SRGB);
+		Signature.SettingsKey = HashCombine(Signature.SettingsKey, GetTypeHash((int32)Texture->LODGroup));
+		Signature.SettingsKey = HashCombine(Signature.SettingsKey, GetTypeHash((int32)Texture->AddressX));
+		Signature.SettingsKey = HashCombine(Signature.SettingsKey, GetTypeHash((int32)Texture->AddressY));
+		Signature.SettingsKey = HashCombine(Signature.SettingsKey, GetTypeHash(Texture->MipGenSettings == TMGS_NoMipmaps));
+		Signature.ContentHash = CityHash64WithSeed((const char*)Pixels.GetData(), Pixels.Num() * sizeof(FColor), ((uint64)Signature.SizeX << 32) | Signature.SizeY);
+		Signature.Thumbnail = GetThumbnail(Pixels, Signature.SizeX, Signature.SizeY);
+		Signatures.Add(Signature);
+	}
+
+	// Larger textures first, so they become representatives of their lower mips
+	Signatures.Sort([](const FTextureSignature& A, const FTextureSignature& B)
+	{
+		const int64 PixelsA = (int64)A.SizeX * A.SizeY;
+		const int64 PixelsB = (int64)B.SizeX * B.SizeY;
+		return PixelsA != PixelsB ? PixelsA > PixelsB : A.Texture->GetPathName() < B.Texture->GetPathName();
+	});
+
+	// Candidates share settings, aspect ratio and thumbnail
+	TMap<uint32, TArray<int32> > Representatives;
+	for (int32 Index = 0; Index < Signatures.Num(); ++Index)
+	{
+		const FTextureSignature& Signature = Signatures[Index];
+		const int32 AspectRatio = FMath::RoundToInt(Signature.SizeX * 1024.f / Signature.SizeY);
+		uint32 GroupKey = HashCombine(Signature.SettingsKey, GetTypeHash(AspectRatio));
+		GroupKey = HashCombine(GroupKey, GetTypeHash(Signature.Thumbnail));
+
+		TArray<int32>& Group = Representatives.FindOrAdd(GroupKey);
+		bool bDuplicate = false;
+		for (int32 RepresentativeIndex : Group)
+		{
+			const int32 Mip = MatchMip(Signatures[RepresentativeIndex], Signature);
+			if (Mip != INDEX_NONE)
+			{
+				FTiXTextureDuplicate& Duplicate = Duplicates.Add(Signature.Texture);
+				Duplicate.Representative = Signatures[RepresentativeIndex].Texture;
+				Duplicate.MipBias = Mip;
+				UE_LOG(LogTiXExporter, Log, TEXT("  %s is mip %d of %s."), *Signature.Texture->GetName(), Mip, *Duplicate.Representative->GetName());
+				bDuplicate = true;
+				break;
+			}
+		}
+		if (!bDuplicate)
+		{
+			Group.Add(Index);
+		}
+	}
+	Textures.Empty();
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TiXExporterDefines.h"
+
+class UTexture;
+class UTexture2D;
+
+/**
+* Finds 2D textures with the same image content, compared on source pixels.
+* A texture may equal another one at the same size, e.g. imported with other compression settings,
+* or be similar to a lower mip of a larger one, e.g. the same image imported at a lower resolution.
+* Same size textures only match on exact source pixels.
+*/
+class FTiXTextureDeduplicator
+{
+public:
+	void AddTexture(UTexture2D* Texture);
+
+	/** Hash and compare all added textures, larger textures become representatives. Game thread only. */
+	void FindDuplicates();
+
+	const TMap<const UTexture*, FTiXTextureDuplicate>& GetDuplicates() const
+	{
+		return Duplicates;
+	}
+
+private:
+	struct FTextureSignature
+	{
+		UTexture2D* Texture;
+		int32 SizeX;
+		int32 SizeY;
+		// Sampling settings, only textures sampled the same way can be shared
+		uint32 SettingsKey;
+		// Exact source pixels
+		uint64 ContentHash;
+		// One bit per cell of a 8x8 thumbnail, set if brighter than average
+		uint64 Thumbnail;
+	};
+
+	static bool ReadSourcePixels(UTexture2D* Texture, TArray<FColor>& OutPixels, int32& OutSizeX, int32& OutSizeY);
+	static void DownsampleHalf(TArray<FColor>& Pixels, int32& SizeX, int32& SizeY);
+	static uint64 GetThumbnail(const TArray<FColor>& Pixels, int32 SizeX, int32 SizeY);
+	static bool IsSimilar(const TArray<FColor>& A, const TArray<FColor>& B);
+
+	/** Return mip 0 if Representative equals Texture, a lower mip similar to Texture, or INDEX_NONE. */
+	static int32 MatchMip(const FTextureSignature& Representative, const FTextureSignature& Texture);
+
+private:
+	TArray<UTexture2D*> Textures;
+	TMap<const UTexture*, FTiXTextureDuplicate> Duplicates;
+};
@@ -0,0 +1,304 @@
+
+#include "FTiXVertexDecoder.h"
+#include "Rendering/PositionVertexBuffer.h"
+#include "Rendering/StaticMeshVertexBuffer.h"
+#include "Rendering/ColorVertexBuffer.h"
+#include "Rendering/SkinWeightVertexBuffer.h"
+#include "RawIndexBuffer.h"
+
+#define TIX_SSE_KERNELS (PLATFORM_ENABLE_VECTORINTRINSICS && PLATFORM_CPU_X86_FAMILY)
+
+#if TIX_SSE_KERNELS
+/** Normalize xyz of 4 vectors, store them as FVector. */
+static FORCEINLINE void StoreSafeNormals4(__m128 V0, __m128 V1, __m128 V2, __m128 V3, uint8* Dst, int32 DstStride, int32 Count)
+{
+	_MM_TRANSPOSE4_PS(V0, V1, V2, V3);
+	const __m128 LengthSquared = _mm_add_ps(_mm_add_ps(_mm_mul_ps(V0, V0), _mm_mul_ps(V1, V1)), _mm_mul_ps(V2, V2));
+	const __m128 Valid = _mm_cmpgt_ps(LengthSquared, _mm_set1_ps(SMALL_NUMBER));
+	// 1 / sqrt(0) is inf, masked to 0 for short vectors
+	const __m128 InvLength = _mm_and_ps(Valid, _mm_div_ps(_mm_set1_ps(1.f), _mm_sqrt_ps(LengthSquared)));
+	V0 = _mm_mul_ps(V0, InvLength);
+	V1 = _mm_mul_ps(V1, InvLength);
+	V2 = _mm_mul_ps(V2, InvLength);
+	V3 = _mm_setzero_ps();
+	_MM_TRANSPOSE4_PS(V0, V1, V2, V3);
+
+	MS_ALIGN(16) float Out[4][4] GCC_ALIGN(16);
+	_mm_store_ps(Out[0], V0);
+	_mm_store_ps(Out[1], V1);
+	_mm_store_ps(Out[2], V2);
+	_mm_store_ps(Out[3], V3);
+	for (int32 i = 0; i < Count; ++i)
+	{
+		FMemory::Memcpy(Dst + i * DstStride, Out[i], sizeof(FVector));
+	}
+}
+
+/** Sign extend 4 int8 to float. */
+static FORCEINLINE __m128 LoadSignedByte4(const uint8* Src)
+{
+	__m128i Packed = _mm_cvtsi32_si128(*(const int32*)Src);
+	Packed = _mm_unpacklo_epi8(Packed, Packed);
+	Packed = _mm_unpacklo_epi16(Packed, Packed);
+	return _mm_cvtepi32_ps(_mm_srai_epi32(Packed, 24));
+}
+
+/** Sign extend 4 int16 to float. */
+static FORCEINLINE __m128 LoadSignedShort4(const uint8* Src)
+{
+	__m128i Packed = _mm_loadl_epi64((const __m128i*)Src);
+	Packed = _mm_unpacklo_epi16(Packed, Packed);
+	return _mm_cvtepi32_ps(_mm_srai_epi32(Packed, 16));
+}
+
+/** 4 halfs in low 16 bits of each lane to float, handles denormals, inf and nan. */
+static FORCEINLINE __m128 HalfToFloat4(__m128i Halfs)
+{
+	const __m128i MaskNoSign = _mm_set1_epi32(0x7fff);
+	const __m128i WasInfNan = _mm_set1_epi32(0x7bff);
+	const __m128i ExpInfNan = _mm_set1_epi32(255 << 23);
+	const __m128 Magic = _mm_castsi128_ps(_mm_set1_epi32((254 - 15) << 23));
+
+	const __m128i ExpMantissa = _mm_and_si128(MaskNoSign, Halfs);
+	const __m128i JustSign = _mm_xor_si128(Halfs, ExpMantissa);
+	const __m128 Scaled = _mm_mul_ps(_mm_castsi128_ps(_mm_slli_epi32(ExpMantissa, 13)), Magic);
+	const __m128i InfNanExp = _mm_and_si128(_mm_cmpgt_epi32(ExpMantissa, WasInfNan), ExpInfNan);
+	const __m128i SignInfNan = _mm_or_si128(_mm_slli_epi32(JustSign, 16), InfNanExp);
+	return _mm_or_ps(Scaled, _mm_castsi128_ps(SignInfNan));
+}
+#endif
+
+void FTiXVertexDecoder::UnpackNormals(const uint8* Src, int32 SrcStride, int32 Num, uint8* Dst, int32 DstStride)
+{
+	const float Scale = 1.f / 127.f;
+#if TIX_SSE_KERNELS
+	const __m128 VScale = _mm_set1_ps(Scale);
+	int32 i = 0;
+	for (; i + 4 <= Num; i += 4)
+	{
+		StoreSafeNormals4(
+			_mm_mul_ps(LoadSignedByte4(Src + (i + 0) * SrcStride), VScale),
+			_mm_mul_ps(LoadSignedByte4(Src + (i + 1) * SrcStride), VScale),
+			_mm_mul_ps(LoadSignedByte4(Src + (i + 2) * SrcStride), VScale),
+			_mm_mul_ps(LoadSignedByte4(Src + (i + 3) * SrcStride), VScale),
+			Dst + i * DstStride, DstStride, 4);
+	}
+	if (i < Num)
+	{
+		__m128 V[4] = { _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps() };
+		for (int32 Tail = 0; i + Tail < Num; ++Tail)
+		{
+			V[Tail] = _mm_mul_ps(LoadSignedByte4(Src + (i + Tail) * SrcStride), VScale);
+		}
+		StoreSafeNormals4(V[0], V[1], V[2], V[3], Dst + i * DstStride, DstStride, Num - i);
+	}
+#else
+	for (int32 i = 0; i < Num; ++i)
+	{
+		const int8* Packed = (const int8*)(Src + i * SrcStride);
+		const FVector V(Packed[0] * Scale, Packed[1] * Scale, Packed[2] * Scale);
+		*(FVector*)(Dst + i * DstStride) = V.GetSafeNormal();
+	}
+#endif
+}
+
+void FTiXVertexDecoder::UnpackNormals16(const uint8* Src, int32 SrcStride, int32 Num, uint8* Dst, int32 DstStride)
+{
+	const float Scale = 1.f / 32767.f;
+#if TIX_SSE_KERNELS
+	const __m128 VScale = _mm_set1_ps(Scale);
+	int32 i = 0;
+	for (; i + 4 <= Num; i += 4)
+	{
+		StoreSafeNormals4(
+			_mm_mul_ps(LoadSignedShort4(Src + (i + 0) * SrcStride), VScale),
+			_mm_mul_ps(LoadSignedShort4(Src + (i + 1) * SrcStride), VScale),
+			_mm_mul_ps(LoadSignedShort4(Src + (i + 2) * SrcStride), VScale),
+			_mm_mul_ps(LoadSignedShort4(Src + (i + 3) * SrcStride), VScale),
+			Dst + i * DstStride, DstStride, 4);
+	}
+	if (i < Num)
+	{
+		__m128 V[4] = { _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps(), _mm_setzero_ps() };
+		for (int32 Tail = 0; i + Tail < Num; ++Tail)
+		{
+			V[Tail] = _mm_mul_ps(LoadSignedShort4(Src + (i + Tail) * SrcStride), VScale);
+		}
+		StoreSafeNormals4(V[0], V[1], V[2], V[3], Dst + i * DstStride, DstStride, Num - i);
+	}
+#else
+	for (int32 i = 0; i < Num; ++i)
+	{
+		const int16* Packed = (const int16*)(Src + i * SrcStride);
+		const FVector V(Packed[0] * Scale, Packed[1] * Scale, Packed[2] * Scale);
+		*(FVector*)(Dst + i * DstStride) = V.GetSafeNormal();
+	}
+#endif
+}
+
+void FTiXVertexDecoder::UnpackHalf2(const uint8* Src, int32 SrcStride, int32 Num, uint8* Dst, int32 DstStride)
+{
+#if TIX_SSE_KERNELS
+	// Two FVector2DHalf per iteration
+	int32 i = 0;
+	for (; i + 2 <= Num; i += 2)
+	{
+		const __m128i Halfs = _mm_unpacklo_epi32(
+			_mm_cvtsi32_si128(*(const int32*)(Src + (i + 0) * SrcStride)),
+			_mm_cvtsi32_si128(*(const int32*)(Src + (i + 1) * SrcStride)));
+		const __m128 Floats = HalfToFloat4(_mm_unpacklo_epi16(Halfs, _mm_setzero_si128()));
+		_mm_storel_pi((__m64*)(Dst + (i + 0) * DstStride), Floats);
+		_mm_storeh_pi((__m64*)(Dst + (i + 1) * DstStride), Floats);
+	}
+	if (i < Num)
+	{
+		const __m128i Halfs = _mm_cvtsi32_si128(*(const int32*)(Src + i * SrcStride));
+		const __m128 Floats = HalfToFloat4(_mm_unpacklo_epi16(Halfs, _mm_setzero_si128()));
+		_mm_storel_pi((__m64*)(Dst + i * DstStride), Floats);
+	}
+#else
+	for (int32 i = 0; i < Num; ++i)
+	{
+		*(FVector2D*)(Dst + i * DstStride) = FVector2D(*(const FVector2DHalf*)(Src + i * SrcStride));
+	}
+#endif
+}
+
+/** Decode render vertices [First, First + Num) to [OutFirst, OutFirst + Num) of OutVertices, streams are compile time constants. */
+template<uint32 VsFormat>
+static void DecodeRange(const FTiXRenderVertexBuffers& Buffers, float PositionScale, int32 First, int32 Num, FTiXVertexStreams& OutVertices, int32 OutFirst)
+{
+	FVector* Positions = OutVertices.Positions.GetData() + OutFirst;
+	for (int32 i = 0; i < Num; ++i)
+	{
+		Positions[i] = Buffers.Positions->VertexPosition(First + i) * PositionScale;
+	}
+
+	const FStaticMeshVertexBuffer* StaticMeshVertices = Buffers.StaticMeshVertices;
+	if ((VsFormat & (EVSSEG_NORMAL | EVSSEG_TANGENT)) != 0)
+	{
+		// Tangent datum is TangentX followed by TangentZ
+		const bool bHighPrecision = StaticMeshVertices->GetUseHighPrecisionTangentBasis();
+		const int32 NormalSize = bHighPrecision ? sizeof(FPackedRGBA16N) : sizeof(FPackedNormal);
+		const int32 TangentStride = NormalSize * 2;
+		const uint8* Tangents = (const uint8*)StaticMeshVertices->GetTangentData() + First * TangentStride;
+		auto Unpack = bHighPrecision ? &FTiXVertexDecoder::UnpackNormals16 : &FTiXVertexDecoder::UnpackNormals;
+		if ((VsFormat & EVSSEG_NORMAL) != 0)
+		{
+			Unpack(Tangents + NormalSize, TangentStride, Num, (uint8*)(OutVertices.Normals.GetData() + OutFirst), sizeof(FVector));
+		}
+		if ((VsFormat & EVSSEG_TANGENT) != 0)
+		{
+			Unpack(Tangents, TangentStride, Num, (uint8*)(OutVertices.Tangents.GetData() + OutFirst), sizeof(FVector));
+		}
+	}
+
+	const int32 NumTexCoords = (VsFormat & EVSSEG_TEXCOORD1) != 0 ? 2 : ((VsFormat & EVSSEG_TEXCOORD0) != 0 ? 1 : 0);
+	if (NumTexCoords > 0)
+	{
+		// UVs of a vertex are packed together
+		const bool bFullPrecision = StaticMeshVertices->GetUseFullPrecisionUVs();
+		const int32 UVSize = bFullPrecision ? sizeof(FVector2D) : sizeof(FVector2DHalf);
+		const int32 UVStride = UVSize * StaticMeshVertices->GetNumTexCoords();
+		const uint8* UVs = (const uint8*)StaticMeshVertices->GetTexCoordData() + First * UVStride;
+		for (int32 UVIndex = 0; UVIndex < NumTexCoords; ++UVIndex)
+		{
+			if ((VsFormat & (UVIndex == 0 ? EVSSEG_TEXCOORD0 : EVSSEG_TEXCOORD1)) == 0)
+			{
+				continue;
+			}
+			const uint8* Src = UVs + UVIndex * UVSize;
+			FVector2D* Dst = OutVertices.TexCoords[UVIndex].GetData() + OutFirst;
+			if (bFullPrecision)
+			{
+				for (int32 i = 0; i < Num; ++i)
+				{
+					Dst[i] = *(const FVector2D*)(Src + i * UVStride);
+				}
+			}
+			else
+			{
+				FTiXVertexDecoder::UnpackHalf2(Src, UVStride, Num, (uint8*)Dst, sizeof(FVector2D));
+			}
+		}
+	}
+
+	if ((VsFormat & EVSSEG_COLOR) != 0)
+	{
+		// Colors are kept packed
+		FMemory::Memcpy(OutVertices.Colors.GetData() + OutFirst, &Buffers.Colors->VertexColor(First), Num * sizeof(FColor));
+	}
+
+	if ((VsFormat & (EVSSEG_BLENDINDEX | EVSSEG_BLENDWEIGHT)) != 0)
+	{
+		check(Buffers.SkinWeights != nullptr);
+		FTiXBlendIndices* BlendIndices = OutVertices.BlendIndices.GetData() + OutFirst;
+		FTiXBlendWeights* BlendWeights = OutVertices.BlendWeights.GetData() + OutFirst;
+		for (int32 i = 0; i < Num; ++i)
+		{
+			const FSkinWeightInfo Info = Buffers.SkinWeights->GetVertexSkinWeights(First + i);
+			for (int32 Influence = 0; Influence < 4; ++Influence)
+			{
+				BlendIndices[i].Bones[Influence] = Info.InfluenceBones[Influence];
+				BlendWeights[i].Weights[Influence] = Info.InfluenceWeights[Influence];
+			}
+		}
+	}
+}
+
+/** Decodes runs of referenced vertices with DecodeRange of the dispatched streams. */
+struct FDecodeRunsFunctor
+{
+	const FTiXRenderVertexBuffers& Buffers;
+	float PositionScale;
+	const TArray<uint32>& Remap;
+	FTiXVertexStreams& OutVertices;
+
+	template<uint32 VsFormat>
+	void Run()
+	{
+		// Decode runs of referenced vertices, so kernels work on contiguous ranges
+		const int32 NumVertices = Remap.Num();
+		int32 RunStart = INDEX_NONE;
+		for (int32 VertexIndex = 0; VertexIndex <= NumVertices; ++VertexIndex)
+		{
+			const bool bReferenced = VertexIndex < NumVertices && Remap[VertexIndex] != MAX_uint32;
+			if (bReferenced && RunStart == INDEX_NONE)
+			{
+				RunStart = VertexIndex;
+			}
+			else if (!bReferenced && RunStart != INDEX_NONE)
+			{
+				DecodeRange<VsFormat>(Buffers, PositionScale, RunStart, VertexIndex - RunStart, OutVertices, Remap[RunStart]);
+				RunStart = INDEX_NONE;
+			}
+		}
+	}
+};
+
+void FTiXVertexDecoder::DecodeReferencedVertices(const FTiXRenderVertexBuffers& Buffers, uint32 VsFormat, float PositionScale, const FIndexArrayView& Indices, FTiXVertexStreams& OutVertices, TArray<uint32>& OutRemap)
+{
+	const int32 NumVertices = Buffers.Positions->GetNumVertices();
+	OutRemap.Init(MAX_uint32, NumVertices);
+	for (int32 i = 0; i < Indices.Num(); ++i)
+	{
+		const uint32 Index = Indices[i];
+		check(Index < (uint32)NumVertices);
+		OutRemap[Index] = 0;
+	}
+
+	// Referenced vertices keep their order
+	uint32 NumReferenced = 0;
+	for (uint32& Remapped : OutRemap)
+	{
+		if (Remapped != MAX_uint32)
+		{
+			Remapped = NumReferenced++;
+		}
+	}
+	OutVertices = FTiXVertexStreams(VsFormat);
+	OutVertices.SetNumZeroed(NumReferenced);
+
+	FDecodeRunsFunctor DecodeRuns = { Buffers, PositionScale, OutRemap, OutVertices };
+	DispatchVsFormat(VsFormat, DecodeRuns);
+}
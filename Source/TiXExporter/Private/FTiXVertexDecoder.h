@@ -0,0 +1,49 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TiXExporterDefines.h"
+
+class FPositionVertexBuffer;
+class FStaticMeshVertexBuffer;
+class FColorVertexBuffer;
+class FSkinWeightVertexBuffer;
+class FIndexArrayView;
+
+/** Vertex buffers of one render data LOD, shared by static and skeletal meshes. */
+struct FTiXRenderVertexBuffers
+{
+	const FPositionVertexBuffer* Positions;
+	const FStaticMeshVertexBuffer* StaticMeshVertices;
+	const FColorVertexBuffer* Colors;
+	// nullptr for static meshes
+	const FSkinWeightVertexBuffer* SkinWeights;
+
+	FTiXRenderVertexBuffers()
+		: Positions(nullptr)
+		, StaticMeshVertices(nullptr)
+		, Colors(nullptr)
+		, SkinWeights(nullptr)
+	{}
+};
+
+/**
+* Decodes referenced render data vertices into compact FTiXVertexStreams, each vertex once.
+* Packed tangents and half UVs are unpacked by SIMD kernels over contiguous ranges.
+* Strides of kernels are in bytes.
+*/
+class FTiXVertexDecoder
+{
+public:
+	/**
+	* Decode vertices referenced by Indices into OutVertices in render data order, unreferenced vertices are skipped.
+	* OutRemap maps each render vertex to its index in OutVertices, MAX_uint32 if unreferenced.
+	*/
+	static void DecodeReferencedVertices(const FTiXRenderVertexBuffers& Buffers, uint32 VsFormat, float PositionScale, const FIndexArrayView& Indices, FTiXVertexStreams& OutVertices, TArray<uint32>& OutRemap);
+
+	/** FPackedNormal to normalized FVector, zero if too short, as GetSafeNormal(). */
+	static void UnpackNormals(const uint8* Src, int32 SrcStride, int32 Num, uint8* Dst, int32 DstStride);
+	/** FPackedRGBA16N to normalized FVector, zero if too short. */
+	static void UnpackNormals16(const uint8* Src, int32 SrcStride, int32 Num, uint8* Dst, int32 DstStride);
+	/** FVector2DHalf to FVector2D. */
+	static void UnpackHalf2(const uint8* Src, int32 SrcStride, int32 Num, uint8* Dst, int32 DstStride);
+};
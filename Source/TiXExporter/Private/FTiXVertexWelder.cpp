@@ -0,0 +1,214 @@
+
+#include "FTiXVertexWelder.h"
+#include "Hash/CityHash.h"
+
+// Keep the table at most half full
+static const int32 SlotsPerVertex = 2;
+
+template<bool bQuantize>
+static FORCEINLINE void AddKeyFloats(const float* Values, int32 Count, float InvCellSize, int32* OutKey, int32& K)
+{
+	for (int32 i = 0; i < Count; ++i)
+	{
+		float Value = Values[i];
+		if (bQuantize)
+		{
+			OutKey[K++] = FMath::FloorToInt(Value * InvCellSize);
+		}
+		else
+		{
+			// Treat -0 as 0, bits of other values are compared exactly
+			Value += 0.f;
+			FMemory::Memcpy(&OutKey[K++], &Value, sizeof(int32));
+		}
+	}
+}
+
+template<uint32 VsFormat, bool bQuantize>
+static int32 MakeVertexKey(const FTiXVertexStreams& Source, int32 SourceIndex, float InvCellSize, int32* OutKey)
+{
+	int32 K = 0;
+	// Epsilon is in position units, so only positions go to grid cells, they are always the first 3 of a key
+	AddKeyFloats<bQuantize>(&Source.Positions[SourceIndex].X, 3, InvCellSize, OutKey, K);
+	if ((VsFormat & EVSSEG_NORMAL) != 0)
+		AddKeyFloats<false>(&Source.Normals[SourceIndex].X, 3, 0.f, OutKey, K);
+	if ((VsFormat & EVSSEG_TEXCOORD0) != 0)
+		AddKeyFloats<false>(&Source.TexCoords[0][SourceIndex].X, 2, 0.f, OutKey, K);
+	if ((VsFormat & EVSSEG_TEXCOORD1) != 0)
+		AddKeyFloats<false>(&Source.TexCoords[1][SourceIndex].X, 2, 0.f, OutKey, K);
+	if ((VsFormat & EVSSEG_TANGENT) != 0)
+		AddKeyFloats<false>(&Source.Tangents[SourceIndex].X, 3, 0.f, OutKey, K);
+	// Colors and skin weights are packed, their bits are compared
+	if ((VsFormat & EVSSEG_COLOR) != 0)
+	{
+		const uint32 Color = Source.Colors[SourceIndex].DWColor();
+		FMemory::Memcpy(&OutKey[K++], &Color, sizeof(int32));
+	}
+	if ((VsFormat & EVSSEG_BLENDINDEX) != 0)
+	{
+		const FTiXBlendIndices& BlendIndices = Source.BlendIndices[SourceIndex];
+		FMemory::Memcpy(&OutKey[K], BlendIndices.Bones, sizeof(int32) * 2);
+		K += 2;
+		FMemory::Memcpy(&OutKey[K++], &Source.BlendWeights[SourceIndex], sizeof(int32));
+	}
+	return K;
+}
+
+template<uint32 VsFormat>
+static int32 CopyStreamsVertex(FTiXVertexStreams& Vertices, const FTiXVertexStreams& Source, int32 SourceIndex)
+{
+	return Vertices.AddVertex<VsFormat>(Source, SourceIndex);
+}
+
+/** Picks functions of the dispatched stream mask. */
+struct FSelectVertexFuncsFunctor
+{
+	bool bQuantize;
+	FTiXVertexWelder::FMakeKeyFunc MakeKey;
+	FTiXVertexWelder::FAddVertexFunc CopyVertex;
+
+	template<uint32 VsFormat>
+	void Run()
+	{
+		MakeKey = bQuantize ? &MakeVertexKey<VsFormat, true> : &MakeVertexKey<VsFormat, false>;
+		CopyVertex = &CopyStreamsVertex<VsFormat>;
+	}
+};
+
+/** Number of int32 MakeVertexKey writes. */
+static int32 GetVertexKeySize(uint32 VsFormat)
+{
+	int32 KeySize = 3;
+	if ((VsFormat & EVSSEG_NORMAL) != 0)
+		KeySize += 3;
+	if ((VsFormat & EVSSEG_TEXCOORD0) != 0)
+		KeySize += 2;
+	if ((VsFormat & EVSSEG_TEXCOORD1) != 0)
+		KeySize += 2;
+	if ((VsFormat & EVSSEG_TANGENT) != 0)
+		KeySize += 3;
+	if ((VsFormat & EVSSEG_COLOR) != 0)
+		KeySize += 1;
+	if ((VsFormat & EVSSEG_BLENDINDEX) != 0)
+		KeySize += 3;
+	return KeySize;
+}
+
+FTiXVertexWelder::FTiXVertexWelder(uint32 InVsFormat, int32 NumExpectedVertices, float InWeldEpsilon)
+	: WeldEpsilon(FMath::Max(InWeldEpsilon, 0.f))
+	, InvCellSize(InWeldEpsilon > 0.f ? 0.5f / InWeldEpsilon : 0.f)
+	, MakeKey(nullptr)
+	, CopyVertex(nullptr)
+	, KeyStride(GetVertexKeySize(InVsFormat) + 1)
+	, Vertices(InVsFormat)
+	, SlotMask(0)
+{
+	FSelectVertexFuncsFunctor SelectFuncs = { InWeldEpsilon > 0.f, nullptr, nullptr };
+	DispatchVsFormat(InVsFormat, SelectFuncs);
+	MakeKey = SelectFuncs.MakeKey;
+	CopyVertex = SelectFuncs.CopyVertex;
+
+	NumExpectedVertices = FMath::Max(NumExpectedVertices, 1);
+	Vertices.Reserve(NumExpectedVertices);
+	Keys.Reserve(NumExpectedVertices * KeyStride);
+	Hashes.Reserve(NumExpectedVertices);
+	Rehash(FMath::RoundUpToPowerOfTwo(NumExpectedVertices * SlotsPerVertex));
+}
+
+void FTiXVertexWelder::Rehash(int32 NumSlots)
+{
+	Slots.Init(INDEX_NONE, NumSlots);
+	SlotMask = (uint32)NumSlots - 1;
+	for (int32 VertexIndex = 0; VertexIndex < Hashes.Num(); ++VertexIndex)
+	{
+		uint32 Slot = (uint32)Hashes[VertexIndex] & SlotMask;
+		while (Slots[Slot] != INDEX_NONE)
+		{
+			Slot = (Slot + 1) & SlotMask;
+		}
+		Slots[Slot] = VertexIndex;
+	}
+}
+
+int32 FTiXVertexWelder::FindVertex(const int32* Key, uint64 Hash, const FVector* Position, uint32& OutSlot) const
+{
+	const int32 KeySize = KeyStride * sizeof(int32);
+
+	// Linear probing
+	uint32 Slot = (uint32)Hash & SlotMask;
+	while (Slots[Slot] != INDEX_NONE)
+	{
+		const int32 VertexIndex = Slots[Slot];
+		if (Hashes[VertexIndex] == Hash && FMemory::Memcmp(&Keys[VertexIndex * KeyStride], Key, KeySize) == 0 &&
+			(Position == nullptr || FVector::DistSquared(Vertices.Positions[VertexIndex], *Position) <= WeldEpsilon * WeldEpsilon))
+		{
+			return VertexIndex;
+		}
+		Slot = (Slot + 1) & SlotMask;
+	}
+	OutSlot = Slot;
+	return INDEX_NONE;
+}
+
+int32 FTiXVertexWelder::AddVertex(const FTiXVertexStreams& Source, int32 SourceIndex, uint32 Group)
+{
+	int32 Key[32];
+	check(KeyStride <= UE_ARRAY_COUNT(Key));
+	const int32 GroupKey = MakeKey(Source, SourceIndex, InvCellSize, Key);
+	checkSlow(GroupKey + 1 == KeyStride);
+	FMemory::Memcpy(&Key[GroupKey], &Group, sizeof(int32));
+	const int32 KeySize = KeyStride * sizeof(int32);
+	const uint64 Hash = CityHash64((const char*)Key, KeySize);
+
+	uint32 Slot = 0;
+	if (WeldEpsilon <= 0.f)
+	{
+		const int32 VertexIndex = FindVertex(Key, Hash, nullptr, Slot);
+		if (VertexIndex != INDEX_NONE)
+		{
+			return VertexIndex;
+		}
+	}
+	else
+	{
+		// Cells are 2 epsilon wide, so positions within epsilon are in this cell or the nearer neighbor on each axis
+		const FVector& Position = Source.Positions[SourceIndex];
+		int32 Neighbors[3];
+		for (int32 Axis = 0; Axis < 3; ++Axis)
+		{
+			Neighbors[Axis] = Position[Axis] * InvCellSize - Key[Axis] < 0.5f ? Key[Axis] - 1 : Key[Axis] + 1;
+		}
+
+		// This cell first, so equal positions weld as without epsilon
+		int32 NeighborKey[32];
+		FMemory::Memcpy(NeighborKey, Key, KeySize);
+		for (int32 Cell = 0; Cell < 8; ++Cell)
+		{
+			for (int32 Axis = 0; Axis < 3; ++Axis)
+			{
+				NeighborKey[Axis] = (Cell & (1 << Axis)) != 0 ? Neighbors[Axis] : Key[Axis];
+			}
+			const uint64 NeighborHash = Cell == 0 ? Hash : CityHash64((const char*)NeighborKey, KeySize);
+			uint32 NeighborSlot = 0;
+			const int32 VertexIndex = FindVertex(NeighborKey, NeighborHash, &Position, NeighborSlot);
+			if (VertexIndex != INDEX_NONE)
+			{
+				return VertexIndex;
+			}
+			if (Cell == 0)
+			{
+				Slot = NeighborSlot;
+			}
+		}
+	}
+
+	const int32 VertexIndex = CopyVertex(Vertices, Source, SourceIndex);
+	Keys.Append(Key, KeyStride);
+	Hashes.Add(Hash);
+	Slots[Slot] = VertexIndex;
+	if (Vertices.Num() * SlotsPerVertex > Slots.Num())
+	{
+		Rehash(Slots.Num() * 2);
+	}
+	return VertexIndex;
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "CoreMinimal.h"
+#include "TiXExporterDefines.h"
+
+/**
+* Welds equal vertices into a unique vertex list.
+* Only streams in VsFormat are compared and kept.
+* With a positive epsilon, vertices weld if their positions are within epsilon of each other.
+* Positions are hashed by grid cells 2 epsilon wide, and the cell of a vertex and its 7 neighbors
+* toward the vertex are searched, so no pair within epsilon is missed at a cell boundary.
+* A vertex welds into the first vertex found, welding is not transitive.
+* Normals, tangents, texcoords and other attributes are in different units, they always compare exactly.
+* Vertices of different groups never weld, e.g. skinned sections with their own bone maps.
+*/
+class FTiXVertexWelder
+{
+public:
+	/** NumExpectedVertices is an upper bound of unique vertices, usually the index count. */
+	FTiXVertexWelder(uint32 InVsFormat, int32 NumExpectedVertices, float InWeldEpsilon);
+
+	/** Return index of the unique vertex equal to vertex SourceIndex of Source in Group, add it if not found. */
+	int32 AddVertex(const FTiXVertexStreams& Source, int32 SourceIndex, uint32 Group = 0);
+
+	const FTiXVertexStreams& GetVertices() const
+	{
+		return Vertices;
+	}
+	FTiXVertexStreams& GetVertices()
+	{
+		return Vertices;
+	}
+
+	/** Write key of streams in VsFormat, returns number of int32 written. */
+	typedef int32 (*FMakeKeyFunc)(const FTiXVertexStreams& Source, int32 SourceIndex, float InvCellSize, int32* OutKey);
+	/** Append a vertex of Source to Vertices. */
+	typedef int32 (*FAddVertexFunc)(FTiXVertexStreams& Vertices, const FTiXVertexStreams& Source, int32 SourceIndex);
+
+private:
+	void Rehash(int32 NumSlots);
+	/** Return vertex with the key, and within epsilon of Position if not null. Slot ending the probe is returned if not found. */
+	int32 FindVertex(const int32* Key, uint64 Hash, const FVector* Position, uint32& OutSlot) const;
+
+private:
+	float WeldEpsilon;
+	float InvCellSize;
+	// Specialized for active streams of VsFormat
+	FMakeKeyFunc MakeKey;
+	FAddVertexFunc CopyVertex;
+	// Number of int32 in key of a vertex, decided by active streams, the group included
+	int32 KeyStride;
+
+	FTiXVertexStreams Vertices;
+	TArray<int32> Keys;
+	TArray<uint64> Hashes;
+
+	// Open addressing table of vertex indices, INDEX_NONE for empty slots, size is power of 2
+	TArray<int32> Slots;
+	uint32 SlotMask;
+};
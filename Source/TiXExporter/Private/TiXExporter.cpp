@@ -1,20 +1,111 @@
 // Copyright 1998-2018 Epic Games, Inc. All Rights Reserved.
 
 #include "TiXExporter.h"
+#include "Engine/Engine.h"
+#include "Editor.h"
+#include "UObject/UObjectGlobals.h"
+#include "Materials/MaterialInterface.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/SkeletalMesh.h"
+#include "Engine/Texture.h"
+#include "FTiXExportSession.h"
 
 #define LOCTEXT_NAMESPACE "FTiXExporterModule"
 
 void FTiXExporterModule::StartupModule()
 {
 	// This code will execute after your module is loaded into memory; the exact timing is specified in the .uplugin file per-module
-	
+	ObjectPropertyChangedHandle = FCoreUObjectDelegates::OnObjectPropertyChanged.AddRaw(this, &FTiXExporterModule::OnObjectPropertyChanged);
+	PostUndoRedoHandle = FEditorDelegates::PostUndoRedo.AddRaw(this, &FTiXExporterModule::OnSceneChanged);
+	// Built lighting changes what reflection captures and sky light see
+	LightingBuildKeptHandle = FEditorDelegates::OnLightingBuildKept.AddRaw(this, &FTiXExporterModule::OnSceneChanged);
+
+	// Actor events live in GEngine, which may not exist yet
+	if (GEngine != nullptr)
+	{
+		RegisterSceneChangeEvents();
+	}
+	else
+	{
+		PostEngineInitHandle = FCoreDelegates::OnPostEngineInit.AddRaw(this, &FTiXExporterModule::RegisterSceneChangeEvents);
+	}
 }
 
 void FTiXExporterModule::ShutdownModule()
 {
 	// This function may be called during shutdown to clean up your module.  For modules that support dynamic reloading,
 	// we call this function before unloading the module.
-	
+	FCoreDelegates::OnPostEngineInit.Remove(PostEngineInitHandle);
+	FCoreUObjectDelegates::OnObjectPropertyChanged.Remove(ObjectPropertyChangedHandle);
+	FEditorDelegates::PostUndoRedo.Remove(PostUndoRedoHandle);
+	FEditorDelegates::OnLightingBuildKept.Remove(LightingBuildKeptHandle);
+	if (GEngine != nullptr)
+	{
+		GEngine->OnActorMoved().Remove(ActorMovedHandle);
+		GEngine->OnLevelActorAdded().Remove(LevelActorAddedHandle);
+		GEngine->OnLevelActorDeleted().Remove(LevelActorDeletedHandle);
+	}
+}
+
+void FTiXExporterModule::RegisterSceneChangeEvents()
+{
+	FCoreDelegates::OnPostEngineInit.Remove(PostEngineInitHandle);
+	PostEngineInitHandle.Reset();
+	ActorMovedHandle = GEngine->OnActorMoved().AddRaw(this, &FTiXExporterModule::OnLevelActorChanged);
+	LevelActorAddedHandle = GEngine->OnLevelActorAdded().AddRaw(this, &FTiXExporterModule::OnLevelActorChanged);
+	LevelActorDeletedHandle = GEngine->OnLevelActorDeleted().AddRaw(this, &FTiXExporterModule::OnLevelActorDeleted);
+}
+
+void FTiXExporterModule::OnObjectPropertyChanged(UObject* Object, FPropertyChangedEvent& PropertyChangedEvent)
+{
+	// Assets drawn in the scene change what captures see, and tiles using them
+	if (Object != nullptr &&
+		(Object->IsA<UMaterialInterface>() || Object->IsA<UStaticMesh>() || Object->IsA<USkeletalMesh>() || Object->IsA<UTexture>()))
+	{
+		OnSceneChanged();
+		// Dragging a value sends interactive changes, then a final one
+		if (PropertyChangedEvent.ChangeType != EPropertyChangeType::Interactive)
+		{
+			FTiXExportSession::Get().NotifyAssetChanged(Object);
+		}
+		return;
+	}
+
+	// Other objects only change the scene as actors or their components in the exported world
+	const AActor* Actor = Cast<AActor>(Object);
+	if (Actor == nullptr && Object != nullptr)
+	{
+		Actor = Object->GetTypedOuter<AActor>();
+	}
+	if (Actor != nullptr && FTiXExportSession::Get().IsTrackedWorld(Actor->GetWorld()))
+	{
+		// Tiles of this actor need to be exported again
+		OnSceneChanged();
+		FTiXExportSession::Get().NotifyActorChanged(Actor, false);
+	}
+}
+
+void FTiXExporterModule::OnLevelActorChanged(AActor* Actor)
+{
+	if (Actor != nullptr && FTiXExportSession::Get().IsTrackedWorld(Actor->GetWorld()))
+	{
+		OnSceneChanged();
+		FTiXExportSession::Get().NotifyActorChanged(Actor, false);
+	}
+}
+
+void FTiXExporterModule::OnLevelActorDeleted(AActor* Actor)
+{
+	if (Actor != nullptr && FTiXExportSession::Get().IsTrackedWorld(Actor->GetWorld()))
+	{
+		OnSceneChanged();
+		FTiXExportSession::Get().NotifyActorChanged(Actor, true);
+	}
+}
+
+void FTiXExporterModule::OnSceneChanged()
+{
+	FTiXExportSession::Get().NotifySceneChanged();
 }
 
 #undef LOCTEXT_NAMESPACE
@@ -35,12 +35,24 @@
 #include "Serialization/JsonWriter.h"
 #include "Serialization/JsonSerializer.h"
 #include "HAL/PlatformFilemanager.h"
+#include "HAL/FileManager.h"
 #include "Misc/FileHelper.h"
 #include "Serialization/BufferArchive.h"
 #include "ImageUtils.h"
 #include "Runtime/Engine/Classes/Exporters/Exporter.h"
 #include "TiXExporterHelper.h"
 #include "FTiXMeshCluster.h"
+#include "FTiXExportSession.h"
+#include "FTiXMeshDeduplicator.h"
+#include "FTiXTextureDeduplicator.h"
+#include "FTiXVertexWelder.h"
+#include "FTiXVertexDecoder.h"
+#include "FTiXMeshOptimizer.h"
+#include "FTiXMeshSimplifier.h"
+#include "Misc/SecureHash.h"
+#include "EngineUtils.h"
+#include "Async/ParallelFor.h"
+#include "Hash/CityHash.h"
 
 DEFINE_LOG_CATEGORY(LogTiXExporter);
 
@@ -73,58 +85,277 @@ void UTiXExporterBPLibrary::SetMeshClusterSize(int32 Triangles)
 	TiXExporterSetting.MeshClusterSize = Triangles;
 }
 
+void UTiXExporterBPLibrary::SetEnableIncrementalExport(bool bEnable)
+{
+	TiXExporterSetting.bEnableIncrementalExport = bEnable;
+}
+
+void UTiXExporterBPLibrary::SetEnableMeshDeduplication(bool bEnable)
+{
+	TiXExporterSetting.bEnableMeshDeduplication = bEnable;
+}
+
+void UTiXExporterBPLibrary::SetEnableTextureDeduplication(bool bEnable)
+{
+	TiXExporterSetting.bEnableTextureDeduplication = bEnable;
+}
+
+void UTiXExporterBPLibrary::SetEnableMaterialInstanceDeduplication(bool bEnable)
+{
+	TiXExporterSetting.bEnableMaterialInstanceDeduplication = bEnable;
+}
+
+void UTiXExporterBPLibrary::SetEnableVertexWelding(bool bEnable)
+{
+	TiXExporterSetting.bEnableVertexWelding = bEnable;
+}
+
+void UTiXExporterBPLibrary::SetVertexWeldEpsilon(float Epsilon)
+{
+	TiXExporterSetting.VertexWeldEpsilon = FMath::Max(Epsilon, 0.f);
+}
+
+void UTiXExporterBPLibrary::SetEnableVertexCacheOptimization(bool bEnable)
+{
+	TiXExporterSetting.bEnableVertexCacheOptimization = bEnable;
+}
+
+void UTiXExporterBPLibrary::SetEnableOverdrawOptimization(bool bEnable)
+{
+	TiXExporterSetting.bEnableOverdrawOptimization = bEnable;
+}
+
+void UTiXExporterBPLibrary::SetOverdrawCacheThreshold(float Threshold)
+{
+	TiXExporterSetting.OverdrawCacheThreshold = FMath::Max(Threshold, 1.f);
+}
+
+void UTiXExporterBPLibrary::SetEnableVertexFetchOptimization(bool bEnable)
+{
+	TiXExporterSetting.bEnableVertexFetchOptimization = bEnable;
+}
+
+void UTiXExporterBPLibrary::SetEnableLODGeneration(bool bEnable)
+{
+	TiXExporterSetting.bEnableLODGeneration = bEnable;
+}
+
+void UTiXExporterBPLibrary::SetTargetMeshLODs(int32 NumLODs)
+{
+	TiXExporterSetting.TargetMeshLODs = FMath::Clamp(NumLODs, 1, 8);
+}
+
+void UTiXExporterBPLibrary::SetLODTriangleRatio(float Ratio)
+{
+	TiXExporterSetting.LODTriangleRatio = FMath::Clamp(Ratio, 0.05f, 0.95f);
+}
+
+void UTiXExporterBPLibrary::SetLODMaxError(float Error)
+{
+	TiXExporterSetting.LODMaxError = FMath::Max(Error, 0.f);
+}
+
+void UTiXExporterBPLibrary::SetRemoveDegenerateTriangles(bool bRemove)
+{
+	TiXExporterSetting.bRemoveDegenerateTriangles = bRemove;
+}
+
+void UTiXExporterBPLibrary::SetDegenerateAreaThreshold(float Area)
+{
+	TiXExporterSetting.DegenerateAreaThreshold = FMath::Max(Area, 0.f);
+}
+
+void UTiXExporterBPLibrary::SetSliverAspectThreshold(float Aspect)
+{
+	TiXExporterSetting.SliverAspectThreshold = FMath::Max(Aspect, 0.f);
+}
+
+static uint32 GetExporterSettingHash(const TArray<FString>& MeshComponents)
+{
+	// Settings that change the content of exported files
+	uint32 Hash = GetTypeHash(TIX_EXPORT_CACHE_VERSION);
+	Hash = HashCombine(Hash, GetTypeHash(TiXExporterSetting.TileSize));
+	Hash = HashCombine(Hash, GetTypeHash(TiXExporterSetting.MeshVertexPositionScale));
+	Hash = HashCombine(Hash, GetTypeHash(TiXExporterSetting.bIgnoreMaterial ? 1 : 0));
+	Hash = HashCombine(Hash, GetTypeHash(TiXExporterSetting.bEnableTextureDeduplication ? 1 : 0));
+	Hash = HashCombine(Hash, GetTypeHash(TiXExporterSetting.bEnableMaterialInstanceDeduplication ? 1 : 0));
+	Hash = HashCombine(Hash, GetTypeHash(TiXExporterSetting.bEnableVertexWelding ? 1 : 0));
+	Hash = HashCombine(Hash, GetTypeHash(TiXExporterSetting.VertexWeldEpsilon));
+	Hash = HashCombine(Hash, GetTypeHash(TiXExporterSetting.bEnableVertexCacheOptimization ? 1 : 0));
+	Hash = HashCombine(Hash, GetTypeHash(TiXExporterSetting.bEnableOverdrawOptimization ? 1 : 0));
+	Hash = HashCombine(Hash, GetTypeHash(TiXExporterSetting.OverdrawCacheThreshold));
+	Hash = HashCombine(Hash, GetTypeHash(TiXExporterSetting.bEnableVertexFetchOptimization ? 1 : 0));
+	Hash = HashCombine(Hash, GetTypeHash(TiXExporterSetting.bEnableLODGeneration ? 1 : 0));
+	Hash = HashCombine(Hash, GetTypeHash(TiXExporterSetting.TargetMeshLODs));
+	Hash = HashCombine(Hash, GetTypeHash(TiXExporterSetting.LODTriangleRatio));
+	Hash = HashCombine(Hash, GetTypeHash(TiXExporterSetting.LODMaxError));
+	Hash = HashCombine(Hash, GetTypeHash(TiXExporterSetting.bRemoveDegenerateTriangles ? 1 : 0));
+	Hash = HashCombine(Hash, GetTypeHash(TiXExporterSetting.DegenerateAreaThreshold));
+	Hash = HashCombine(Hash, GetTypeHash(TiXExporterSetting.SliverAspectThreshold));
+	for (const auto& Component : MeshComponents)
+	{
+		Hash = HashCombine(Hash, GetTypeHash(Component));
+	}
+	return Hash;
+}
+
 
 const FString ExtName = TEXT(".tasset");
 const int32 MaxTextureSize = 1024;
 
-inline FIntPoint GetPointByPosition(const FVector& Position, float TileSize)
+/**
+* Write pipeline states referenced by materials of this session to scene.
+* States already in the scene are kept, materials of tiles not exported this time still use them.
+*/
+static void SavePipelineStatesToJson(TSharedPtr<FJsonObject> JsonObject)
 {
-	float X = Position.X / TileSize;
-	float Y = Position.Y / TileSize;
-	if (X < 0.f)
+	TMap<FString, TSharedPtr<FJsonValue> > JStates;
+	const TArray< TSharedPtr<FJsonValue> >* JOldStates;
+	if (JsonObject->TryGetArrayField(TEXT("pipeline_states"), JOldStates))
 	{
-		X -= 1.f;
+		for (const TSharedPtr<FJsonValue>& JState : *JOldStates)
+		{
+			JStates.Add(JState->AsObject()->GetStringField(TEXT("name")), JState);
+		}
 	}
-	if (Y < 0.f)
+	for (const auto& StatePair : FTiXExportSession::Get().GetPipelineStates())
 	{
-		Y -= 1.f;
+		TSharedPtr<FJsonObject> JState = MakeShareable(new FJsonObject);
+		JState->SetStringField(TEXT("name"), StatePair.Key);
+		for (const auto& Field : StatePair.Value->Values)
+		{
+			JState->SetField(Field.Key, Field.Value);
+		}
+		JStates.Add(StatePair.Key, MakeShareable(new FJsonValueObject(JState)));
 	}
-	return FIntPoint(int32(X), int32(Y));
+	JStates.KeySort(TLess<FString>());
+
+	TArray< TSharedPtr<FJsonValue> > JPipelineStates;
+	JStates.GenerateValueArray(JPipelineStates);
+	JsonObject->SetArrayField(TEXT("pipeline_states"), JPipelineStates);
 }
 
-UTiXExporterBPLibrary::UTiXExporterBPLibrary(const FObjectInitializer& ObjectInitializer)
-: Super(ObjectInitializer)
+/** Hash of everything in reflection captures and sky lights that affects captured results. */
+static uint32 GetCaptureStateHash(const UWorld* World, const TArray<AReflectionCapture*>& RCActors, const TArray<ASkyLight*>& SkyLightActors)
 {
+	auto HashTransform = [](const FTransform& Transform, uint32 Hash)
+	{
+		Hash = HashCombine(Hash, GetTypeHash(Transform.GetLocation()));
+		Hash = HashCombine(Hash, GetTypeHash(Transform.GetRotation().Euler()));
+		return HashCombine(Hash, GetTypeHash(Transform.GetScale3D()));
+	};
+
+	uint32 Hash = GetTypeHash(World->GetPathName());
+	Hash = HashCombine(Hash, RCActors.Num());
+	for (const AReflectionCapture* RCActor : RCActors)
+	{
+		const UReflectionCaptureComponent* RCComponent = RCActor->GetCaptureComponent();
+		Hash = HashCombine(Hash, GetTypeHash(RCActor->GetPathName()));
+		if (RCComponent != nullptr)
+		{
+			Hash = HashTransform(RCComponent->GetComponentTransform(), Hash);
+			Hash = HashCombine(Hash, GetTypeHash(RCComponent->Brightness));
+			Hash = HashCombine(Hash, GetTypeHash((int32)RCComponent->ReflectionSourceType));
+			Hash = HashCombine(Hash, GetTypeHash(RCComponent->Cubemap));
+			Hash = HashCombine(Hash, GetTypeHash(RCComponent->SourceCubemapAngle));
+			Hash = HashCombine(Hash, GetTypeHash(RCComponent->CaptureOffset));
+		}
+	}
+	Hash = HashCombine(Hash, SkyLightActors.Num());
+	for (const ASkyLight* SkyLightActor : SkyLightActors)
+	{
+		const USkyLightComponent* SkyLightComponent = SkyLightActor->GetLightComponent();
+		Hash = HashCombine(Hash, GetTypeHash(SkyLightActor->GetPathName()));
+		if (SkyLightComponent != nullptr)
+		{
+			Hash = HashTransform(SkyLightComponent->GetComponentTransform(), Hash);
+			Hash = HashCombine(Hash, GetTypeHash((int32)SkyLightComponent->SourceType));
+			Hash = HashCombine(Hash, GetTypeHash(SkyLightComponent->Cubemap));
+			Hash = HashCombine(Hash, GetTypeHash(SkyLightComponent->SourceCubemapAngle));
+			Hash = HashCombine(Hash, GetTypeHash(SkyLightComponent->Intensity));
+			Hash = HashCombine(Hash, GetTypeHash(SkyLightComponent->SkyDistanceThreshold));
+			Hash = HashCombine(Hash, GetTypeHash((uint32)SkyLightComponent->bLowerHemisphereIsBlack));
+			Hash = HashCombine(Hash, GetTypeHash(SkyLightComponent->LowerHemisphereColor));
+		}
+	}
+	return Hash;
 }
 
-void UTiXExporterBPLibrary::ExportCurrentScene(
-	AActor * Actor, 
-	const FString& ExportPath, 
-	const TArray<FString>& SceneComponents, 
-	const TArray<FString>& MeshComponents)
+/** Actors used by scene export, sorted by class. */
+struct FTiXSceneActors
 {
-	UWorld * CurrentWorld = Actor->GetWorld();
-	ULevel * CurrentLevel = CurrentWorld->GetCurrentLevel();
+	TArray<AStaticMeshActor*> StaticMeshActors;
+	TArray<ASkeletalMeshActor*> SkeletalMeshActors;
+	TArray<AInstancedFoliageActor*> FoliageActors;
+	TArray<ASkyLight*> SkyLights;
+	TArray<AReflectionCapture*> ReflectionCaptures;
+	TArray<ACameraActor*> Cameras;
+	TArray<ADirectionalLight*> DirectionalLights;
+	TArray<ALandscape*> Landscapes;
+};
+
+/** Walk the actor list once and dispatch actors by class. Hidden actors are kept, callers decide to skip them. */
+static void CollectSceneActors(UWorld* World, FTiXSceneActors& OutActors)
+{
+	// Actor iteration touches UObjects, so it stays on game thread
+	check(IsInGameThread());
+	for (TActorIterator<AActor> It(World); It; ++It)
+	{
+		AActor* A = *It;
+		if (AStaticMeshActor* SMActor = Cast<AStaticMeshActor>(A))
+		{
+			OutActors.StaticMeshActors.Add(SMActor);
+		}
+		else if (ASkeletalMeshActor* SKMActor = Cast<ASkeletalMeshActor>(A))
+		{
+			OutActors.SkeletalMeshActors.Add(SKMActor);
+		}
+		else if (AInstancedFoliageActor* FoliageActor = Cast<AInstancedFoliageActor>(A))
+		{
+			OutActors.FoliageActors.Add(FoliageActor);
+		}
+		else if (ASkyLight* SkyLight = Cast<ASkyLight>(A))
+		{
+			OutActors.SkyLights.Add(SkyLight);
+		}
+		else if (AReflectionCapture* RCActor = Cast<AReflectionCapture>(A))
+		{
+			OutActors.ReflectionCaptures.Add(RCActor);
+		}
+		else if (ACameraActor* Camera = Cast<ACameraActor>(A))
+		{
+			OutActors.Cameras.Add(Camera);
+		}
+		else if (ADirectionalLight* DirectionalLight = Cast<ADirectionalLight>(A))
+		{
+			OutActors.DirectionalLights.Add(DirectionalLight);
+		}
+		else if (ALandscape* Landscape = Cast<ALandscape>(A))
+		{
+			OutActors.Landscapes.Add(Landscape);
+		}
+	}
+}
 
-	TMap<UStaticMesh *, TArray<FTiXInstance> > SMInstances;
-	TMap<USkeletalMesh*, TArray<ASkeletalMeshActor*> > SKMActors;
-	TMap<USkeletalMesh*, UAnimationAsset* > RelatedAnimations;
+/** Collect static mesh instances, skeletal mesh actors, sky lights and reflection captures to export. */
+static void CollectSceneInstances(const FTiXSceneActors& SceneActors, const TArray<FString>& SceneComponents, FTiXSceneInstances& OutInstances)
+{
+	TMap<UStaticMesh *, TArray<FTiXInstance> >& SMInstances = OutInstances.SMInstances;
+	TMap<USkeletalMesh*, TArray<ASkeletalMeshActor*> >& SKMActors = OutInstances.SKMActors;
+	TMap<USkeletalMesh*, UAnimationAsset* >& RelatedAnimations = OutInstances.RelatedAnimations;
+	TArray< ASkyLight* >& SkyLightActors = OutInstances.SkyLightActors;
+	TArray< AReflectionCapture* >& RCActors = OutInstances.RCActors;
 
-	TArray<AActor*> Actors;
 	int32 a = 0;
-	UE_LOG(LogTiXExporter, Log, TEXT("Export tix scene ..."));
-
 	// Collect Static Meshes
 	if (ContainComponent(SceneComponents, TEXT("STATIC_MESH")))
 	{
 		UE_LOG(LogTiXExporter, Log, TEXT("  Static mesh actors..."));
-		UGameplayStatics::GetAllActorsOfClass(Actor, AStaticMeshActor::StaticClass(), Actors);
-		for (auto A : Actors)
+		for (AStaticMeshActor* SMActor : SceneActors.StaticMeshActors)
 		{
-			if (A->IsHidden())
+			if (SMActor->IsHidden())
 				continue;
-			UE_LOG(LogTiXExporter, Log, TEXT(" Actor %d : %s."), a++, *A->GetName());
-			AStaticMeshActor * SMActor = static_cast<AStaticMeshActor*>(A);
+			UE_LOG(LogTiXExporter, Log, TEXT(" Actor %d : %s."), a++, *SMActor->GetName());
 			UStaticMesh * StaticMesh = SMActor->GetStaticMeshComponent()->GetStaticMesh();
 
 			TArray<FTiXInstance>& Instances = SMInstances.FindOrAdd(StaticMesh);
@@ -141,15 +372,12 @@ void UTiXExporterBPLibrary::ExportCurrentScene(
 	if (ContainComponent(SceneComponents, TEXT("SKELETAL_MESH")))
 	{
 		UE_LOG(LogTiXExporter, Log, TEXT(" Skeletal mesh actors..."));
-		Actors.Empty();
-		UGameplayStatics::GetAllActorsOfClass(Actor, ASkeletalMeshActor::StaticClass(), Actors);
-		for (auto A : Actors)
+		for (ASkeletalMeshActor* SKMActor : SceneActors.SkeletalMeshActors)
 		{
-			if (A->IsHidden())
+			if (SKMActor->IsHidden())
 				continue;
-			UE_LOG(LogTiXExporter, Log, TEXT(" Actor %d : %s."), a++, *A->GetName());
+			UE_LOG(LogTiXExporter, Log, TEXT(" Actor %d : %s."), a++, *SKMActor->GetName());
 
-			ASkeletalMeshActor* SKMActor = static_cast<ASkeletalMeshActor*>(A);
 			USkeletalMesh* SkeletalMesh = SKMActor->GetSkeletalMeshComponent()->SkeletalMesh;
 
 			if (SKMActor->GetSkeletalMeshComponent()->GetAnimationMode() == EAnimationMode::AnimationSingleNode)
@@ -172,130 +400,103 @@ void UTiXExporterBPLibrary::ExportCurrentScene(
 	if (ContainComponent(SceneComponents, TEXT("FOLIAGE_AND_GRASS")))
 	{
 		UE_LOG(LogTiXExporter, Log, TEXT(" Foliage and grass  actors..."));
-		Actors.Empty();
-		UGameplayStatics::GetAllActorsOfClass(Actor, AInstancedFoliageActor::StaticClass(), Actors);
-		for (auto A : Actors)
+		for (AInstancedFoliageActor* FoliageActor : SceneActors.FoliageActors)
 		{
-			if (A->IsHidden())
+			if (FoliageActor->IsHidden())
 				continue;
-			UE_LOG(LogTiXExporter, Log, TEXT(" Actor %d : %s."), a++, *A->GetName());
-			AInstancedFoliageActor * FoliageActor = (AInstancedFoliageActor*)A;
+			UE_LOG(LogTiXExporter, Log, TEXT(" Actor %d : %s."), a++, *FoliageActor->GetName());
 			for (const auto& FoliagePair : FoliageActor->FoliageInfos)
 			{
 				const FFoliageInfo& FoliageInfo = *FoliagePair.Value;
 
 				UHierarchicalInstancedStaticMeshComponent* MeshComponent = FoliageInfo.GetComponent();
-				TArray<FInstancedStaticMeshInstanceData> MeshDataArray = MeshComponent->PerInstanceSMData;
+				const TArray<FInstancedStaticMeshInstanceData>& MeshDataArray = MeshComponent->PerInstanceSMData;
 
 				UStaticMesh * StaticMesh = MeshComponent->GetStaticMesh();
 				TArray<FTiXInstance>& Instances = SMInstances.FindOrAdd(StaticMesh);
 
-				for (auto& MeshMatrix : MeshDataArray)
+				// Instance data is plain memory, convert large foliage types on worker threads
+				const int32 FirstInstance = Instances.Num();
+				Instances.AddDefaulted(MeshDataArray.Num());
+				const float PositionScale = TiXExporterSetting.MeshVertexPositionScale;
+				ParallelFor(MeshDataArray.Num(), [&](int32 Index)
 				{
-					FTransform MeshTransform = FTransform(MeshMatrix.Transform);
-					FTiXInstance InstanceInfo;
-					InstanceInfo.Position = MeshTransform.GetLocation() * TiXExporterSetting.MeshVertexPositionScale;
+					FTransform MeshTransform = FTransform(MeshDataArray[Index].Transform);
+					FTiXInstance& InstanceInfo = Instances[FirstInstance + Index];
+					InstanceInfo.Position = MeshTransform.GetLocation() * PositionScale;
 					InstanceInfo.Rotation = MeshTransform.GetRotation();
 					InstanceInfo.Scale = MeshTransform.GetScale3D();
 					InstanceInfo.Transform = MeshTransform;
-					Instances.Add(InstanceInfo);
-				}
+				}, MeshDataArray.Num() < 4096);
 			}
 		}
 	}
 
 	// Collect Sky light
-	TArray< ASkyLight* > SkyLightActors;
 	{
 		UE_LOG(LogTiXExporter, Log, TEXT(" Sky light actors..."));
-		Actors.Empty();
-		UGameplayStatics::GetAllActorsOfClass(Actor, ASkyLight::StaticClass(), Actors);
-		for (auto A : Actors)
+		for (ASkyLight* SkyLightActor : SceneActors.SkyLights)
 		{
-			if (A->IsHidden())
+			if (SkyLightActor->IsHidden())
 				continue;
-			UE_LOG(LogTiXExporter, Log, TEXT(" Actor %d : %s."), a++, *A->GetName());
-			ASkyLight* SkyLightActor = static_cast<ASkyLight*>(A);
+			UE_LOG(LogTiXExporter, Log, TEXT(" Actor %d : %s."), a++, *SkyLightActor->GetName());
 			SkyLightActors.Add(SkyLightActor);
 		}
 	}
 
 	// Collect Reflection Captures
-	TArray< AReflectionCapture* > RCActors;
 	{
 		UE_LOG(LogTiXExporter, Log, TEXT(" Reflection capture actors..."));
-		Actors.Empty();
-		UGameplayStatics::GetAllActorsOfClass(Actor, AReflectionCapture::StaticClass(), Actors);
-		for (auto A : Actors)
+		for (AReflectionCapture* RCActor : SceneActors.ReflectionCaptures)
 		{
-			if (A->IsHidden())
+			if (RCActor->IsHidden())
 				continue;
-			UE_LOG(LogTiXExporter, Log, TEXT(" Actor %d : %s."), a++, *A->GetName());
-			AReflectionCapture* RCActor = static_cast<AReflectionCapture*>(A);
+			UE_LOG(LogTiXExporter, Log, TEXT(" Actor %d : %s."), a++, *RCActor->GetName());
 			RCActors.Add(RCActor);
 		}
 	}
 
-	// Export mesh resources
-	if (ContainComponent(SceneComponents, TEXT("STATIC_MESH")))
-	{
-		UE_LOG(LogTiXExporter, Log, TEXT("  Static meshes..."));
-
-		for (auto& MeshPair : SMInstances)
-		{
-			UStaticMesh * Mesh = MeshPair.Key;
-			ExportStaticMeshFromRenderData(Mesh, ExportPath, MeshComponents);
-		}
-	}
-	if (ContainComponent(SceneComponents, TEXT("SKELETAL_MESH")))
+	// Find static meshes with the same geometry up to a rigid transform
+	if (TiXExporterSetting.bEnableMeshDeduplication)
 	{
-		UE_LOG(LogTiXExporter, Log, TEXT("  Skeletal meshes..."));
-		for (auto& MeshPair : SKMActors)
+		UE_LOG(LogTiXExporter, Log, TEXT(" Static mesh duplicates..."));
+		FTiXMeshDeduplicator MeshDeduplicator;
+		for (const auto& MeshPair : SMInstances)
 		{
-			USkeletalMesh* SkeletalMesh = MeshPair.Key;
-			ExportSkeletalMeshFromRenderData(SkeletalMesh, ExportPath, MeshComponents);
+			// Rotation can not be moved into an instance with non-uniform scale without shearing
+			bool bUniformScale = true;
+			for (const FTiXInstance& Instance : MeshPair.Value)
+			{
+				if (!Instance.Transform.GetScale3D().AllComponentsEqual(KINDA_SMALL_NUMBER))
+				{
+					bUniformScale = false;
+					break;
+				}
+			}
+			MeshDeduplicator.AddMesh(MeshPair.Key, bUniformScale);
 		}
-
-		UE_LOG(LogTiXExporter, Log, TEXT("  Related Animations..."));
-		for (auto& AnimPair : RelatedAnimations)
+		MeshDeduplicator.FindDuplicates();
+		OutInstances.MeshDuplicates = MeshDeduplicator.GetDuplicates();
+		for (const auto& DuplicatePair : OutInstances.MeshDuplicates)
 		{
-			USkeletalMesh* SkeletalMesh = AnimPair.Key;
-			UAnimationAsset* AnimAsset = AnimPair.Value;
-			ExportAnimationAsset(AnimAsset, ExportPath);
+			UE_LOG(LogTiXExporter, Log, TEXT("  %s exported as %s."), *DuplicatePair.Key->GetName(), *DuplicatePair.Value.Representative->GetName());
 		}
 	}
-	
-	UE_LOG(LogTiXExporter, Log, TEXT("Scene structure: "));
-	// Calc total static mesh instances
-	int32 NumSMInstances = 0;
-	for (const auto& MeshPair : SMInstances)
-	{
-		const UStaticMesh * Mesh = MeshPair.Key;
-		FString MeshName = Mesh->GetName();
-		const TArray<FTiXInstance>& Instances = MeshPair.Value;
-
-		UE_LOG(LogTiXExporter, Log, TEXT("  %s : %d instances."), *MeshName, Instances.Num());
-		NumSMInstances += Instances.Num();
-	}
-	// Calc total skeletal mesh actors
-	int32 NumSKMActors = 0;
-	for (const auto& MeshPair : SKMActors)
-	{
-		const USkeletalMesh* Mesh = MeshPair.Key;
-		FString MeshName = Mesh->GetName();
-		const TArray<ASkeletalMeshActor*>& _Actors = MeshPair.Value;
-
-		UE_LOG(LogTiXExporter, Log, TEXT("  %s : %d actors."), *MeshName, _Actors.Num());
-		NumSKMActors += _Actors.Num();
-	}
+}
 
+/** Sort collected instances into scene tiles by position. If TileFilter is not null, only tiles in it are filled. */
+static void SortSceneTiles(const FTiXSceneInstances& SceneInstances, const TSet<FIntPoint>* TileFilter, TMap<FIntPoint, FTiXSceneTile>& Tiles)
+{
+	const TMap<UStaticMesh *, TArray<FTiXInstance> >& SMInstances = SceneInstances.SMInstances;
+	const TMap<USkeletalMesh*, TArray<ASkeletalMeshActor*> >& SKMActors = SceneInstances.SKMActors;
+	const TArray< AReflectionCapture* >& RCActors = SceneInstances.RCActors;
 
-	TMap< FIntPoint, FTiXSceneTile> Tiles;
 	// Sort static mesh into scene tiles
 	for (const auto& MeshPair : SMInstances)
 	{
 		UStaticMesh * Mesh = MeshPair.Key;
 		const TArray<FTiXInstance>& Instances = MeshPair.Value;
+		const FTiXMeshDuplicate* Duplicate = SceneInstances.MeshDuplicates.Find(Mesh);
 
 		for (const auto& Ins : Instances)
 		{
@@ -306,14 +507,26 @@ void UTiXExporterBPLibrary::ExportCurrentScene(
 				continue;
 			}
 			FIntPoint InsPoint = GetPointByPosition(Ins.Position, TiXExporterSetting.TileSize);
+			if (TileFilter != nullptr && !TileFilter->Contains(InsPoint))
+			{
+				continue;
+			}
 			FTiXSceneTile& Tile = Tiles.FindOrAdd(InsPoint);
 
 			Tile.Position = InsPoint;
 			Tile.TileSize = TiXExporterSetting.TileSize;
 
-			// Add instances
-			TArray<FTiXInstance>& TileInstances = Tile.TileSMInstances.FindOrAdd(Mesh);
-			TileInstances.Add(Ins);
+			// Add instances, duplicates are added to their representatives
+			if (Duplicate != nullptr)
+			{
+				TArray<FTiXInstance>& TileInstances = Tile.TileSMInstances.FindOrAdd(Duplicate->Representative);
+				TileInstances.Add(FTiXMeshDeduplicator::FoldInstance(Ins, *Duplicate, TiXExporterSetting.MeshVertexPositionScale));
+			}
+			else
+			{
+				TArray<FTiXInstance>& TileInstances = Tile.TileSMInstances.FindOrAdd(Mesh);
+				TileInstances.Add(Ins);
+			}
 
 			// Add instances count
 			++Tile.SMInstanceCount;
@@ -351,6 +564,10 @@ void UTiXExporterBPLibrary::ExportCurrentScene(
 				continue;
 			}
 			FIntPoint InsPoint = GetPointByPosition(Position, TiXExporterSetting.TileSize);
+			if (TileFilter != nullptr && !TileFilter->Contains(InsPoint))
+			{
+				continue;
+			}
 			FTiXSceneTile& Tile = Tiles.FindOrAdd(InsPoint);
 
 			Tile.Position = InsPoint;
@@ -380,21 +597,16 @@ void UTiXExporterBPLibrary::ExportCurrentScene(
 		}
 	}
 
-	// Export reflection captures's ibl cube maps
-	FString UpdateReason = TEXT("all levels");
-	UReflectionCaptureComponent::UpdateReflectionCaptureContents(CurrentWorld, *UpdateReason, true);
-	for (auto RCActor : RCActors)
-	{
-		FString ActorName = RCActor->GetName();
-		ExportReflectionCapture(RCActor, ExportPath);
-	}
-
 	// Sort reflection capture actors into scene tiles
 	for (auto RCActor : RCActors)
 	{
 		FVector Position = RCActor->GetTransform().GetLocation()* TiXExporterSetting.MeshVertexPositionScale;
 
 		FIntPoint InsPoint = GetPointByPosition(Position, TiXExporterSetting.TileSize);
+		if (TileFilter != nullptr && !TileFilter->Contains(InsPoint))
+		{
+			continue;
+		}
 		FTiXSceneTile& Tile = Tiles.FindOrAdd(InsPoint);
 
 		Tile.Position = InsPoint;
@@ -403,114 +615,209 @@ void UTiXExporterBPLibrary::ExportCurrentScene(
 		// Add reflection capture actor
 		Tile.ReflectionCaptures.Add(RCActor);
 	}
+}
 
-	// output json
+/** Recapture reflection captures only if they or the scene changed since last capture, then read them back. */
+static void UpdateReflectionCaptures(UWorld* World, const TArray<AReflectionCapture*>& RCActors, const TArray<ASkyLight*>& SkyLightActors)
+{
+	FTiXExportSession& Session = FTiXExportSession::Get();
+
+	// Recapture reflection captures and sky lights only if they or the scene changed since last export
+	const uint32 CaptureStateHash = GetCaptureStateHash(World, RCActors, SkyLightActors);
+	if (!Session.AreCapturesUpToDate(CaptureStateHash))
 	{
-		TSharedPtr<FJsonObject> JsonObject = MakeShareable(new FJsonObject);
+		Session.ResetCaptures(CaptureStateHash);
+		FString UpdateReason = TEXT("all levels");
+		UReflectionCaptureComponent::UpdateReflectionCaptureContents(World, *UpdateReason, true);
+	}
+	else
+	{
+		UE_LOG(LogTiXExporter, Log, TEXT("  Scene captures are up to date, reuse captured data."));
+	}
+	Session.ReadbackReflectionCaptures(World, RCActors);
+}
 
-		// output basic info
-		JsonObject->SetStringField(TEXT("name"), CurrentWorld->GetName());
-		JsonObject->SetStringField(TEXT("type"), TEXT("scene"));
-		JsonObject->SetNumberField(TEXT("version"), 1);
-		JsonObject->SetStringField(TEXT("desc"), TEXT("Scene tiles information from TiX exporter."));
-		JsonObject->SetNumberField(TEXT("static_mesh_total"), SMInstances.Num());
-		JsonObject->SetNumberField(TEXT("sm_instances_total"), NumSMInstances);
-		JsonObject->SetNumberField(TEXT("skm_actors_total"), NumSKMActors);
+UTiXExporterBPLibrary::UTiXExporterBPLibrary(const FObjectInitializer& ObjectInitializer)
+: Super(ObjectInitializer)
+{
+}
 
-		// output cameras
-		TArray<AActor*> Cameras;
-		UGameplayStatics::GetAllActorsOfClass(Actor, ACameraActor::StaticClass(), Cameras);
-		if (Cameras.Num() > 0)
+/** Sun and sky light of the scene, written by full exports and refreshed by dirty tile exports. */
+static TSharedPtr<FJsonObject> ExportSceneEnvironment(UWorld* CurrentWorld, const FTiXSceneActors& SceneActors)
+{
+	//TODO: Export mainlight and skylight to tiles
+	FTiXExportSession& Session = FTiXExportSession::Get();
+	TSharedPtr<FJsonObject> JEnvironment = MakeShareable(new FJsonObject);
+	const TArray<ADirectionalLight*>& SunLights = SceneActors.DirectionalLights;
+	if (SunLights.Num() > 0)
+	{
+		//for (auto A : SunLights)
+		// Only export 1 sun light
+		TSharedPtr<FJsonObject> JSunLight = MakeShareable(new FJsonObject);
+		auto A = SunLights[0];
 		{
-			TArray< TSharedPtr<FJsonValue> > JCameras;
-			for (auto A : Cameras)
-			{
-				ACameraActor * Cam = Cast<ACameraActor>(A);
-				UCameraComponent * CamComp = Cam->GetCameraComponent();
-				TSharedPtr<FJsonObject> JCamera = MakeShareable(new FJsonObject);
+			ADirectionalLight * SunLight = static_cast<ADirectionalLight *>(A);
+			ULightComponent * LightComponent = SunLight->GetLightComponent();
 
-				FVector CamDir = CamComp->GetComponentToWorld().GetRotation().Vector();
-				CamDir.Normalize();
-				FVector CamLocation = CamComp->GetComponentToWorld().GetTranslation();
-				FVector CamTarget = CamLocation + CamDir * 100.f;
-				FRotator CamRot = CamComp->GetComponentToWorld().GetRotation().Rotator();
-
-				CamLocation *= TiXExporterSetting.MeshVertexPositionScale;
-				CamTarget *= TiXExporterSetting.MeshVertexPositionScale;
-
-				TArray< TSharedPtr<FJsonValue> > JLocation, JTarget, JRotator;
-				ConvertToJsonArray(CamLocation, JLocation);
-				ConvertToJsonArray(CamTarget, JTarget);
-				ConvertToJsonArray(CamRot, JRotator);
-				JCamera->SetArrayField(TEXT("location"), JLocation);
-				JCamera->SetArrayField(TEXT("target"), JTarget);
-				JCamera->SetArrayField(TEXT("rotator"), JRotator);
-				JCamera->SetNumberField(TEXT("fov"), CamComp->FieldOfView);
-				JCamera->SetNumberField(TEXT("aspect"), CamComp->AspectRatio);
+			JSunLight->SetStringField(TEXT("name"), SunLight->GetName());
 
-				TSharedRef< FJsonValueObject > JsonCamera = MakeShareable(new FJsonValueObject(JCamera));
-				JCameras.Add(JsonCamera);
-			}
-			JsonObject->SetArrayField(TEXT("cameras"), JCameras);
+			TArray< TSharedPtr<FJsonValue> > JDirection, JColor;
+			ConvertToJsonArray(LightComponent->GetDirection(), JDirection);
+			ConvertToJsonArray(LightComponent->GetLightColor(), JColor);
+			JSunLight->SetArrayField(TEXT("direction"), JDirection);
+			JSunLight->SetArrayField(TEXT("color"), JColor);
+			JSunLight->SetNumberField(TEXT("intensity"), LightComponent->Intensity);
 		}
+		JEnvironment->SetObjectField(TEXT("sun_light"), JSunLight);
+	}
+	const TArray<ASkyLight*>& SkyLights = SceneActors.SkyLights;
+	if (SkyLights.Num() > 0)
+	{
+		// Only export 1 sky light
+		TSharedPtr<FJsonObject> JSkyLight = MakeShareable(new FJsonObject);
+		auto A = SkyLights[0];
+		{
+			ASkyLight* SkyLight = static_cast<ASkyLight*>(A);
+			USkyLightComponent* LightComponent = SkyLight->GetLightComponent();
 
-		// output env
-		//TODO: Export mainlight and skylight to tiles
-		TSharedPtr<FJsonObject> JEnvironment = MakeShareable(new FJsonObject);
-		TArray<AActor*> SunLights;
-		UGameplayStatics::GetAllActorsOfClass(Actor, ADirectionalLight::StaticClass(), SunLights);
-		if (SunLights.Num() > 0)
-		{
-			//for (auto A : SunLights)
-			// Only export 1 sun light
-			TSharedPtr<FJsonObject> JSunLight = MakeShareable(new FJsonObject);
-			auto A = SunLights[0];
+			JSkyLight->SetStringField(TEXT("name"), SkyLight->GetName());
+
+			if (Session.FindSkyIrradiance(LightComponent) == nullptr)
 			{
-				ADirectionalLight * SunLight = static_cast<ADirectionalLight *>(A);
-				ULightComponent * LightComponent = SunLight->GetLightComponent();
+				USkyLightComponent::UpdateSkyCaptureContents(CurrentWorld);
+				Session.ReadbackSkyLight(LightComponent);
+			}
+			const FSHVectorRGB3& IrradianceEnvironmentMap = *Session.FindSkyIrradiance(LightComponent);
 
-				JSunLight->SetStringField(TEXT("name"), SunLight->GetName());
+			TArray< TSharedPtr<FJsonValue> > JIrrEnvMap;
+			ConvertToJsonArray(IrradianceEnvironmentMap, JIrrEnvMap);
 
-				TArray< TSharedPtr<FJsonValue> > JDirection, JColor;
-				ConvertToJsonArray(LightComponent->GetDirection(), JDirection);
-				ConvertToJsonArray(LightComponent->GetLightColor(), JColor);
-				JSunLight->SetArrayField(TEXT("direction"), JDirection);
-				JSunLight->SetArrayField(TEXT("color"), JColor);
-				JSunLight->SetNumberField(TEXT("intensity"), LightComponent->Intensity);
-			}
-			JEnvironment->SetObjectField(TEXT("sun_light"), JSunLight);
+			JSkyLight->SetArrayField(TEXT("irradiance_sh3"), JIrrEnvMap);
 		}
-		TArray<AActor*> SkyLights;
-		UGameplayStatics::GetAllActorsOfClass(Actor, ASkyLight::StaticClass(), SkyLights);
-		if (SkyLights.Num() > 0)
-		{
-			USkyLightComponent::UpdateSkyCaptureContents(CurrentWorld);
-			// Only export 1 sky light
-			TSharedPtr<FJsonObject> JSkyLight = MakeShareable(new FJsonObject);
-			auto A = SkyLights[0];
-			{
-				ASkyLight* SkyLight = static_cast<ASkyLight*>(A);
-				USkyLightComponent* LightComponent = SkyLight->GetLightComponent();
+		JEnvironment->SetObjectField(TEXT("sky_light"), JSkyLight);
+	}
+	return JEnvironment;
+}
 
-				JSkyLight->SetStringField(TEXT("name"), SkyLight->GetName());
+void UTiXExporterBPLibrary::ExportCurrentScene(
+	AActor * Actor, 
+	const FString& ExportPath, 
+	const TArray<FString>& SceneComponents, 
+	const TArray<FString>& MeshComponents)
+{
+	UWorld * CurrentWorld = Actor->GetWorld();
+	ULevel * CurrentLevel = CurrentWorld->GetCurrentLevel();
 
-				FSHVectorRGB3 IrradianceEnvironmentMap = LightComponent->GetIrradianceEnvironmentMap();
+	UE_LOG(LogTiXExporter, Log, TEXT("Export tix scene ..."));
 
-				TArray< TSharedPtr<FJsonValue> > JIrrEnvMap;
-				ConvertToJsonArray(IrradianceEnvironmentMap, JIrrEnvMap);
+	FTiXExportSession& Session = FTiXExportSession::Get();
+	Session.BeginSession(ExportPath, GetExporterSettingHash(MeshComponents), TiXExporterSetting.bEnableIncrementalExport);
 
-				JSkyLight->SetArrayField(TEXT("irradiance_sh3"), JIrrEnvMap);
-			}
-			JEnvironment->SetObjectField(TEXT("sky_light"), JSkyLight);
-		}
-		JsonObject->SetObjectField(TEXT("environment"), JEnvironment);
+	FTiXSceneActors SceneActors;
+	CollectSceneActors(CurrentWorld, SceneActors);
 
-		// output landscapes
-		if (ContainComponent(SceneComponents, TEXT("LANDSCAPE")))
-		{
-			UE_LOG(LogTiXExporter, Log, TEXT(" Landscapes..."));
-			TArray<AActor*> LandscapeActors;
-			UGameplayStatics::GetAllActorsOfClass(Actor, ALandscape::StaticClass(), LandscapeActors);
+	FTiXSceneInstances SceneInstances;
+	CollectSceneInstances(SceneActors, SceneComponents, SceneInstances);
+	TMap<UStaticMesh *, TArray<FTiXInstance> >& SMInstances = SceneInstances.SMInstances;
+	TMap<USkeletalMesh*, TArray<ASkeletalMeshActor*> >& SKMActors = SceneInstances.SKMActors;
+	TArray< ASkyLight* >& SkyLightActors = SceneInstances.SkyLightActors;
+	TArray< AReflectionCapture* >& RCActors = SceneInstances.RCActors;
+
+	ExportSceneResources(SceneInstances, CurrentWorld->GetName(), ExportPath, SceneComponents, MeshComponents, true);
+
+	UE_LOG(LogTiXExporter, Log, TEXT("Scene structure: "));
+	// Calc total static mesh instances
+	int32 NumSMInstances = 0;
+	for (const auto& MeshPair : SMInstances)
+	{
+		const UStaticMesh * Mesh = MeshPair.Key;
+		FString MeshName = Mesh->GetName();
+		const TArray<FTiXInstance>& Instances = MeshPair.Value;
+
+		UE_LOG(LogTiXExporter, Log, TEXT("  %s : %d instances."), *MeshName, Instances.Num());
+		NumSMInstances += Instances.Num();
+	}
+	// Calc total skeletal mesh actors
+	int32 NumSKMActors = 0;
+	for (const auto& MeshPair : SKMActors)
+	{
+		const USkeletalMesh* Mesh = MeshPair.Key;
+		FString MeshName = Mesh->GetName();
+		const TArray<ASkeletalMeshActor*>& _Actors = MeshPair.Value;
+
+		UE_LOG(LogTiXExporter, Log, TEXT("  %s : %d actors."), *MeshName, _Actors.Num());
+		NumSKMActors += _Actors.Num();
+	}
+
+
+	TMap< FIntPoint, FTiXSceneTile> Tiles;
+	SortSceneTiles(SceneInstances, nullptr, Tiles);
+
+	// Export reflection captures's ibl cube maps
+	UpdateReflectionCaptures(CurrentWorld, RCActors, SkyLightActors);
+	for (auto RCActor : RCActors)
+	{
+		FString ActorName = RCActor->GetName();
+		ExportReflectionCapture(RCActor, ExportPath);
+	}
+
+	// output json
+	{
+		TSharedPtr<FJsonObject> JsonObject = MakeShareable(new FJsonObject);
+
+		// output basic info
+		JsonObject->SetStringField(TEXT("name"), CurrentWorld->GetName());
+		JsonObject->SetStringField(TEXT("type"), TEXT("scene"));
+		JsonObject->SetNumberField(TEXT("version"), 1);
+		JsonObject->SetStringField(TEXT("desc"), TEXT("Scene tiles information from TiX exporter."));
+		JsonObject->SetNumberField(TEXT("static_mesh_total"), SMInstances.Num());
+		JsonObject->SetNumberField(TEXT("sm_instances_total"), NumSMInstances);
+		JsonObject->SetNumberField(TEXT("skm_actors_total"), NumSKMActors);
+
+		// output cameras
+		const TArray<ACameraActor*>& Cameras = SceneActors.Cameras;
+		if (Cameras.Num() > 0)
+		{
+			TArray< TSharedPtr<FJsonValue> > JCameras;
+			for (auto A : Cameras)
+			{
+				ACameraActor * Cam = Cast<ACameraActor>(A);
+				UCameraComponent * CamComp = Cam->GetCameraComponent();
+				TSharedPtr<FJsonObject> JCamera = MakeShareable(new FJsonObject);
+
+				FVector CamDir = CamComp->GetComponentToWorld().GetRotation().Vector();
+				CamDir.Normalize();
+				FVector CamLocation = CamComp->GetComponentToWorld().GetTranslation();
+				FVector CamTarget = CamLocation + CamDir * 100.f;
+				FRotator CamRot = CamComp->GetComponentToWorld().GetRotation().Rotator();
+
+				CamLocation *= TiXExporterSetting.MeshVertexPositionScale;
+				CamTarget *= TiXExporterSetting.MeshVertexPositionScale;
+
+				TArray< TSharedPtr<FJsonValue> > JLocation, JTarget, JRotator;
+				ConvertToJsonArray(CamLocation, JLocation);
+				ConvertToJsonArray(CamTarget, JTarget);
+				ConvertToJsonArray(CamRot, JRotator);
+				JCamera->SetArrayField(TEXT("location"), JLocation);
+				JCamera->SetArrayField(TEXT("target"), JTarget);
+				JCamera->SetArrayField(TEXT("rotator"), JRotator);
+				JCamera->SetNumberField(TEXT("fov"), CamComp->FieldOfView);
+				JCamera->SetNumberField(TEXT("aspect"), CamComp->AspectRatio);
+
+				TSharedRef< FJsonValueObject > JsonCamera = MakeShareable(new FJsonValueObject(JCamera));
+				JCameras.Add(JsonCamera);
+			}
+			JsonObject->SetArrayField(TEXT("cameras"), JCameras);
+		}
+
+		// output env
+		JsonObject->SetObjectField(TEXT("environment"), ExportSceneEnvironment(CurrentWorld, SceneActors));
+
+		// output landscapes
+		if (ContainComponent(SceneComponents, TEXT("LANDSCAPE")))
+		{
+			UE_LOG(LogTiXExporter, Log, TEXT(" Landscapes..."));
+			const TArray<ALandscape*>& LandscapeActors = SceneActors.Landscapes;
 			if (LandscapeActors.Num() > 0)
 			{
 				TArray< TSharedPtr<FJsonValue> > JsonLandscapes;
@@ -544,9 +851,7 @@ void UTiXExporterBPLibrary::ExportCurrentScene(
 							HeightmapTextures.Add(HeightmapTexture);
 						}
 					}
-					FString ExportPathLocal = ExportPath;
-					VerifyOrCreateDirectory(ExportPathLocal);
-					FString LandscapeHeightmapPath = ExportPathLocal + LandscapeName + "_sections/";
+					FString LandscapeHeightmapPath = NormalizeExportPath(ExportPath) + LandscapeName + "_sections/";
 					TArray< TSharedPtr<FJsonValue> > JHeightmaps;
 					for (int32 TexIndex = 0; TexIndex < HeightmapTextures.Num(); ++TexIndex)
 					{
@@ -559,232 +864,1030 @@ void UTiXExporterBPLibrary::ExportCurrentScene(
 					}
 					JLandscape->SetArrayField(TEXT("heightmaps"), JHeightmaps);
 
-					TSharedRef< FJsonValueObject > JsonLandscape = MakeShareable(new FJsonValueObject(JLandscape));
-					JsonLandscapes.Add(JsonLandscape);
-				}
-				JsonObject->SetArrayField(TEXT("landscape"), JsonLandscapes);
-			}
-		}
+					TSharedRef< FJsonValueObject > JsonLandscape = MakeShareable(new FJsonValueObject(JLandscape));
+					JsonLandscapes.Add(JsonLandscape);
+				}
+				JsonObject->SetArrayField(TEXT("landscape"), JsonLandscapes);
+			}
+		}
+
+		// Output tiles
+		{
+			// Output tile refs to scene
+			TArray< TSharedPtr<FJsonValue> > JTiles;
+			for (const auto& Tile : Tiles)
+			{
+				const FIntPoint& TilePos = Tile.Key;
+				const FTiXSceneTile& SceneTile = Tile.Value;
+
+				const FString TilePathName = FString::Printf(TEXT("%s/t%d_%d"), *CurrentWorld->GetName(), TilePos.X, TilePos.Y);
+				const FString TileKey = GetSceneTileCacheKey(SceneTile, CurrentWorld->GetName());
+				if (!Session.IsSceneTileUpToDate(TilePathName, TileKey))
+				{
+					const bool bExported = ExportSceneTile(SceneTile, CurrentWorld->GetName(), ExportPath);
+					Session.MarkSceneTileExported(TilePathName, bExported ? TileKey : FString());
+				}
+
+				// Export tile point position
+				TArray< TSharedPtr<FJsonValue> > JPosition;
+				ConvertToJsonArray(TilePos, JPosition);
+				//FString TilePathName = FString::Printf(TEXT("%s/t%d_%d.tasset"), *CurrentWorld->GetName(), TilePos.X, TilePos.Y);
+				TSharedRef< FJsonValueArray > JsonValue = MakeShareable(new FJsonValueArray(JPosition));
+				JTiles.Add(JsonValue);
+			}
+			JsonObject->SetArrayField(TEXT("tiles"), JTiles);
+		}
+
+		// Unique pipeline states, created once by runtime and shared by materials
+		SavePipelineStatesToJson(JsonObject);
+
+		SaveJsonToFile(JsonObject, CurrentWorld->GetName(), ExportPath);
+	}
+	SMInstances.Empty();
+	Session.EndSession();
+
+	// Track tiles of actors, so editor changes can be exported by ExportDirtySceneTiles
+	Session.BeginTileTracking(CurrentWorld, ExportPath, TiXExporterSetting.TileSize, TiXExporterSetting.MeshVertexPositionScale, GetExporterSettingHash(MeshComponents));
+	for (AStaticMeshActor* SMActor : SceneActors.StaticMeshActors)
+	{
+		Session.TrackActorTiles(SMActor);
+	}
+	for (ASkeletalMeshActor* SKMActor : SceneActors.SkeletalMeshActors)
+	{
+		Session.TrackActorTiles(SKMActor);
+	}
+	for (AInstancedFoliageActor* FoliageActor : SceneActors.FoliageActors)
+	{
+		Session.TrackActorTiles(FoliageActor);
+	}
+	for (AReflectionCapture* RCActor : SceneActors.ReflectionCaptures)
+	{
+		Session.TrackActorTiles(RCActor);
+	}
+}
+
+void UTiXExporterBPLibrary::ExportDirtySceneTiles(
+	AActor * Actor,
+	const FString& ExportPath,
+	const TArray<FString>& SceneComponents,
+	const TArray<FString>& MeshComponents)
+{
+	UWorld * CurrentWorld = Actor->GetWorld();
+	const FString WorldName = CurrentWorld->GetName();
+	FTiXExportSession& Session = FTiXExportSession::Get();
+
+	// Load scene exported last time, tile list in it will be patched
+	TSharedPtr<FJsonObject> JsonObject;
+	FString SceneJsonString;
+	if (Session.IsTrackingTiles(CurrentWorld, ExportPath, TiXExporterSetting.TileSize, TiXExporterSetting.MeshVertexPositionScale, GetExporterSettingHash(MeshComponents)) &&
+		FFileHelper::LoadFileToString(SceneJsonString, *(NormalizeExportPath(ExportPath) + WorldName + TEXT(".tjs"))))
+	{
+		TSharedRef< TJsonReader<> > Reader = TJsonReaderFactory<>::Create(SceneJsonString);
+		FJsonSerializer::Deserialize(Reader, JsonObject);
+	}
+	if (!JsonObject.IsValid())
+	{
+		UE_LOG(LogTiXExporter, Log, TEXT("No tracked export of %s, export whole scene."), *WorldName);
+		ExportCurrentScene(Actor, ExportPath, SceneComponents, MeshComponents);
+		return;
+	}
+
+	const TSet<FIntPoint> DirtyTiles = Session.ConsumeDirtyTiles();
+	if (DirtyTiles.Num() == 0)
+	{
+		UE_LOG(LogTiXExporter, Log, TEXT("Scene tiles of %s are up to date."), *WorldName);
+		return;
+	}
+	UE_LOG(LogTiXExporter, Log, TEXT("Export %d dirty tiles of %s ..."), DirtyTiles.Num(), *WorldName);
+
+	Session.BeginSession(ExportPath, GetExporterSettingHash(MeshComponents), TiXExporterSetting.bEnableIncrementalExport);
+
+	FTiXSceneActors SceneActors;
+	CollectSceneActors(CurrentWorld, SceneActors);
+
+	FTiXSceneInstances SceneInstances;
+	CollectSceneInstances(SceneActors, SceneComponents, SceneInstances);
+
+	TMap< FIntPoint, FTiXSceneTile> Tiles;
+	SortSceneTiles(SceneInstances, &DirtyTiles, Tiles);
+
+	// Export resources used by dirty tiles, they are up to date in most cases.
+	// Duplicates found over the whole scene by the last full export are reused, so untouched tiles stay consistent.
+	// LOD generation only depends on each mesh, generating for these resources is enough.
+	FTiXSceneInstances TileResources;
+	for (const auto& Tile : Tiles)
+	{
+		for (const auto& MeshPair : Tile.Value.TileSMInstances)
+		{
+			TileResources.SMInstances.FindOrAdd(MeshPair.Key);
+		}
+		for (const auto& MeshPair : Tile.Value.TileSKMActors)
+		{
+			TileResources.SKMActors.FindOrAdd(MeshPair.Key);
+			if (UAnimationAsset* const* AnimAsset = SceneInstances.RelatedAnimations.Find(MeshPair.Key))
+			{
+				TileResources.RelatedAnimations.Add(MeshPair.Key, *AnimAsset);
+			}
+		}
+		TileResources.RCActors.Append(Tile.Value.ReflectionCaptures);
+	}
+	ExportSceneResources(TileResources, WorldName, ExportPath, SceneComponents, MeshComponents, false);
+
+	UpdateReflectionCaptures(CurrentWorld, SceneInstances.RCActors, SceneInstances.SkyLightActors);
+	for (auto RCActor : TileResources.RCActors)
+	{
+		ExportReflectionCapture(RCActor, ExportPath);
+	}
+
+	// Export dirty tiles, and remove tiles become empty
+	for (const FIntPoint& TilePos : DirtyTiles)
+	{
+		const FString TilePathName = FString::Printf(TEXT("%s/t%d_%d"), *WorldName, TilePos.X, TilePos.Y);
+		if (const FTiXSceneTile* SceneTile = Tiles.Find(TilePos))
+		{
+			const FString TileKey = GetSceneTileCacheKey(*SceneTile, WorldName);
+			if (!Session.IsSceneTileUpToDate(TilePathName, TileKey))
+			{
+				const bool bExported = ExportSceneTile(*SceneTile, WorldName, ExportPath);
+				Session.MarkSceneTileExported(TilePathName, bExported ? TileKey : FString());
+				if (!bExported)
+				{
+					// Try again next time
+					Session.AddDirtyTile(TilePos);
+				}
+			}
+		}
+		else if (!IFileManager::Get().Delete(*(NormalizeExportPath(ExportPath) + TilePathName + TEXT(".tjs")), false, false, true))
+		{
+			Session.AddDirtyTile(TilePos);
+		}
+	}
+
+	// Patch tile list and totals of scene in place
+	{
+		TArray< TSharedPtr<FJsonValue> > JTiles;
+		const TArray< TSharedPtr<FJsonValue> >* JOldTiles;
+		if (JsonObject->TryGetArrayField(TEXT("tiles"), JOldTiles))
+		{
+			for (const TSharedPtr<FJsonValue>& JTile : *JOldTiles)
+			{
+				const TArray< TSharedPtr<FJsonValue> >& JPosition = JTile->AsArray();
+				if (JPosition.Num() == 2 && !DirtyTiles.Contains(FIntPoint(int32(JPosition[0]->AsNumber()), int32(JPosition[1]->AsNumber()))))
+				{
+					JTiles.Add(JTile);
+				}
+			}
+		}
+		for (const auto& Tile : Tiles)
+		{
+			TArray< TSharedPtr<FJsonValue> > JPosition;
+			ConvertToJsonArray(Tile.Key, JPosition);
+			JTiles.Add(MakeShareable(new FJsonValueArray(JPosition)));
+		}
+		JsonObject->SetArrayField(TEXT("tiles"), JTiles);
+
+		// Lights are not in tiles, export them again as they may have changed too
+		JsonObject->SetObjectField(TEXT("environment"), ExportSceneEnvironment(CurrentWorld, SceneActors));
+
+		int32 NumSMInstances = 0;
+		for (const auto& MeshPair : SceneInstances.SMInstances)
+		{
+			NumSMInstances += MeshPair.Value.Num();
+		}
+		int32 NumSKMActors = 0;
+		for (const auto& MeshPair : SceneInstances.SKMActors)
+		{
+			NumSKMActors += MeshPair.Value.Num();
+		}
+		JsonObject->SetNumberField(TEXT("static_mesh_total"), SceneInstances.SMInstances.Num());
+		JsonObject->SetNumberField(TEXT("sm_instances_total"), NumSMInstances);
+		JsonObject->SetNumberField(TEXT("skm_actors_total"), NumSKMActors);
+		SavePipelineStatesToJson(JsonObject);
+
+		SaveJsonToFile(JsonObject, WorldName, ExportPath);
+	}
+	Session.EndSession();
+}
+
+/** Parameters of a material instance chain, resolved against its root material. */
+struct FTiXFlattenedMaterialInstance
+{
+	UMaterial* RootMaterial;
+	TArray<FScalarParameterValue> ScalarParameters;
+	TArray<FVectorParameterValue> VectorParameters;
+	TArray<FTextureParameterValue> TextureParameters;
+};
+
+template<typename TParameterValue>
+static void AddOverriddenParameters(const TArray<TParameterValue>& Values, TArray<TParameterValue>& OutValues)
+{
+	for (const TParameterValue& Value : Values)
+	{
+		const bool bOverridden = OutValues.ContainsByPredicate([&Value](const TParameterValue& Other)
+		{
+			return Other.ParameterInfo == Value.ParameterInfo;
+		});
+		if (!bOverridden)
+		{
+			OutValues.Add(Value);
+		}
+	}
+}
+
+/**
+* Walk from the instance to its root material, values in children override values in parents.
+* Walks the same chain export cache keys of material instances are made of.
+*/
+static void FlattenMaterialInstance(const UMaterialInstance* MaterialInstance, FTiXFlattenedMaterialInstance& OutFlattened)
+{
+	TArray<const UMaterialInterface*> MaterialChain;
+	GetMaterialParentChain(MaterialInstance, MaterialChain);
+	for (const UMaterialInterface* MaterialInterface : MaterialChain)
+	{
+		if (const UMaterialInstance* Instance = Cast<UMaterialInstance>(MaterialInterface))
+		{
+			AddOverriddenParameters(Instance->ScalarParameterValues, OutFlattened.ScalarParameters);
+			AddOverriddenParameters(Instance->VectorParameterValues, OutFlattened.VectorParameters);
+			AddOverriddenParameters(Instance->TextureParameterValues, OutFlattened.TextureParameters);
+		}
+	}
+	OutFlattened.RootMaterial = const_cast<UMaterial*>(Cast<UMaterial>(MaterialChain.Last()));
+	check(OutFlattened.RootMaterial != nullptr);
+
+	OutFlattened.TextureParameters.RemoveAll([](const FTextureParameterValue& Value)
+	{
+		return Value.ParameterValue == nullptr;
+	});
+}
+
+/** Material exported for a mesh section, merged material instances are exported as their representative. */
+static UMaterialInterface* GetExportedMaterial(UMaterialInterface* MaterialInterface)
+{
+	UMaterialInterface* Representative = FTiXExportSession::Get().FindMaterialInstanceRepresentative(MaterialInterface);
+	return Representative != nullptr ? Representative : MaterialInterface;
+}
+
+/** Opaque and masked materials write depth, later triangles covered by them are rejected before shading. */
+static bool IsDepthWriteBlendMode(EBlendMode BlendMode)
+{
+	return BlendMode == BLEND_Opaque || BlendMode == BLEND_Masked;
+}
+
+/** Add 2D textures of a material instance and its parents. */
+static void AddMaterialTextures(const UMaterialInterface* MaterialInterface, FTiXTextureDeduplicator& TextureDeduplicator)
+{
+	const UMaterialInstance* MaterialInstance = Cast<UMaterialInstance>(MaterialInterface);
+	if (MaterialInstance == nullptr)
+	{
+		return;
+	}
+	FTiXFlattenedMaterialInstance Flattened;
+	FlattenMaterialInstance(MaterialInstance, Flattened);
+	for (const FTextureParameterValue& TextureValue : Flattened.TextureParameters)
+	{
+		if (UTexture2D* Texture = Cast<UTexture2D>(TextureValue.ParameterValue))
+		{
+			TextureDeduplicator.AddTexture(Texture);
+		}
+	}
+}
+
+/** Identity of a material instance as exported, equal keys export the same file. */
+static FString GetMaterialInstanceKey(const UMaterialInstance* MaterialInstance)
+{
+	FTiXFlattenedMaterialInstance Flattened;
+	FlattenMaterialInstance(MaterialInstance, Flattened);
+
+	auto ParameterName = [](const FMaterialParameterInfo& Info)
+	{
+		return FString::Printf(TEXT("%s:%d:%d"), *Info.Name.ToString(), (int32)Info.Association, Info.Index);
+	};
+	auto FloatBits = [](float Value)
+	{
+		uint32 Bits;
+		FMemory::Memcpy(&Bits, &Value, sizeof(uint32));
+		return Bits;
+	};
+
+	// Render states overridden by instances and static switches compile into different shaders
+	FString Key = Flattened.RootMaterial->GetPathName();
+	Key += FString::Printf(TEXT("|blend=%d|twosided=%d"), (int32)MaterialInstance->GetBlendMode(), MaterialInstance->IsTwoSided() ? 1 : 0);
+	for (const FStaticSwitchParameter& Switch : MaterialInstance->GetStaticParameters().StaticSwitchParameters)
+	{
+		Key += FString::Printf(TEXT("|w:%s=%d"), *ParameterName(Switch.ParameterInfo), Switch.Value ? 1 : 0);
+	}
+
+	// Parameter order decides packing of scalars, keep it in the key
+	for (const FScalarParameterValue& Value : Flattened.ScalarParameters)
+	{
+		Key += FString::Printf(TEXT("|s:%s=%08x"), *ParameterName(Value.ParameterInfo), FloatBits(Value.ParameterValue));
+	}
+	for (const FVectorParameterValue& Value : Flattened.VectorParameters)
+	{
+		const FLinearColor& C = Value.ParameterValue;
+		Key += FString::Printf(TEXT("|v:%s=%08x,%08x,%08x,%08x"), *ParameterName(Value.ParameterInfo), FloatBits(C.R), FloatBits(C.G), FloatBits(C.B), FloatBits(C.A));
+	}
+	for (const FTextureParameterValue& Value : Flattened.TextureParameters)
+	{
+		const UTexture* Texture = Value.ParameterValue;
+		int32 MipBias = 0;
+		if (const FTiXTextureDuplicate* Duplicate = FTiXExportSession::Get().FindTextureDuplicate(Texture))
+		{
+			Texture = Duplicate->Representative;
+			MipBias = Duplicate->MipBias;
+		}
+		Key += FString::Printf(TEXT("|t:%s=%s@%d"), *ParameterName(Value.ParameterInfo), *Texture->GetPathName(), MipBias);
+	}
+	return Key;
+}
+
+void UTiXExporterBPLibrary::FindTextureDuplicates(const FTiXSceneInstances& SceneInstances)
+{
+	UE_LOG(LogTiXExporter, Log, TEXT("  Texture deduplication..."));
+	FTiXTextureDeduplicator TextureDeduplicator;
+	for (const auto& MeshPair : SceneInstances.SMInstances)
+	{
+		for (const FStaticMaterial& Material : MeshPair.Key->StaticMaterials)
+		{
+			AddMaterialTextures(Material.MaterialInterface, TextureDeduplicator);
+		}
+	}
+	for (const auto& MeshPair : SceneInstances.SKMActors)
+	{
+		for (const FSkeletalMaterial& Material : MeshPair.Key->Materials)
+		{
+			AddMaterialTextures(Material.MaterialInterface, TextureDeduplicator);
+		}
+	}
+	TextureDeduplicator.FindDuplicates();
+	UE_LOG(LogTiXExporter, Log, TEXT("  %d textures are exported as other textures."), TextureDeduplicator.GetDuplicates().Num());
+	FTiXExportSession::Get().SetTextureDuplicates(TextureDeduplicator.GetDuplicates());
+}
+
+void UTiXExporterBPLibrary::FindMaterialInstanceDuplicates(const FTiXSceneInstances& SceneInstances)
+{
+	UE_LOG(LogTiXExporter, Log, TEXT("  Material instance deduplication..."));
+	TArray<UMaterialInstance*> MaterialInstances;
+	for (const auto& MeshPair : SceneInstances.SMInstances)
+	{
+		for (const FStaticMaterial& Material : MeshPair.Key->StaticMaterials)
+		{
+			if (UMaterialInstance* MaterialInstance = Cast<UMaterialInstance>(Material.MaterialInterface))
+			{
+				MaterialInstances.AddUnique(MaterialInstance);
+			}
+		}
+	}
+	for (const auto& MeshPair : SceneInstances.SKMActors)
+	{
+		for (const FSkeletalMaterial& Material : MeshPair.Key->Materials)
+		{
+			if (UMaterialInstance* MaterialInstance = Cast<UMaterialInstance>(Material.MaterialInterface))
+			{
+				MaterialInstances.AddUnique(MaterialInstance);
+			}
+		}
+	}
+
+	// Sort by path, so the same instance represents its group in every run
+	MaterialInstances.Sort([](const UMaterialInstance& A, const UMaterialInstance& B)
+	{
+		return A.GetPathName() < B.GetPathName();
+	});
+
+	TMap<FString, UMaterialInstance*> Representatives;
+	TMap<const UMaterialInterface*, UMaterialInterface*> Duplicates;
+	for (UMaterialInstance* MaterialInstance : MaterialInstances)
+	{
+		const FString Key = GetMaterialInstanceKey(MaterialInstance);
+		UMaterialInstance*& Representative = Representatives.FindOrAdd(Key);
+		if (Representative == nullptr)
+		{
+			Representative = MaterialInstance;
+		}
+		else
+		{
+			UE_LOG(LogTiXExporter, Log, TEXT("  %s is merged into %s."), *MaterialInstance->GetName(), *Representative->GetName());
+			Duplicates.Add(MaterialInstance, Representative);
+		}
+	}
+	UE_LOG(LogTiXExporter, Log, TEXT("  %d material instances are merged into %d."), MaterialInstances.Num(), Representatives.Num());
+	FTiXExportSession::Get().SetMaterialInstanceDuplicates(Duplicates);
+}
+
+void UTiXExporterBPLibrary::ExportSceneResources(const FTiXSceneInstances& SceneInstances, const FString& WorldName, const FString& ExportPath, const TArray<FString>& SceneComponents, const TArray<FString>& MeshComponents, bool bFindDuplicates)
+{
+	const TMap<UStaticMesh *, TArray<FTiXInstance> >& SMInstances = SceneInstances.SMInstances;
+	const TMap<USkeletalMesh*, TArray<ASkeletalMeshActor*> >& SKMActors = SceneInstances.SKMActors;
+	const TMap<USkeletalMesh*, UAnimationAsset* >& RelatedAnimations = SceneInstances.RelatedAnimations;
+
+	if (bFindDuplicates)
+	{
+		FTiXExportSession::Get().ResetDuplicates();
+		FTiXExportSession::Get().SetMeshDuplicates(SceneInstances.MeshDuplicates);
+		if (TiXExporterSetting.bEnableTextureDeduplication && !TiXExporterSetting.bIgnoreMaterial)
+		{
+			FindTextureDuplicates(SceneInstances);
+		}
+		if (TiXExporterSetting.bEnableMaterialInstanceDeduplication && !TiXExporterSetting.bIgnoreMaterial)
+		{
+			// After textures, instances using copies of the same texture are merged too
+			FindMaterialInstanceDuplicates(SceneInstances);
+		}
+	}
+	if (TiXExporterSetting.bEnableLODGeneration)
+	{
+		GenerateSceneMeshLODs(SceneInstances, MeshComponents);
+	}
+
+	// Create all output directories up front
+	{
+		TArray<const UObject*> Meshes;
+		for (const auto& MeshPair : SMInstances)
+		{
+			if (!SceneInstances.MeshDuplicates.Contains(MeshPair.Key))
+			{
+				Meshes.Add(MeshPair.Key);
+			}
+		}
+		for (const auto& MeshPair : SKMActors)
+		{
+			Meshes.Add(MeshPair.Key);
+		}
+		for (const auto& AnimPair : RelatedAnimations)
+		{
+			Meshes.Add(AnimPair.Value);
+		}
+		CreateExportDirectories(Meshes, WorldName, ExportPath);
+	}
+
+	// Export mesh resources
+	if (ContainComponent(SceneComponents, TEXT("STATIC_MESH")))
+	{
+		UE_LOG(LogTiXExporter, Log, TEXT("  Static meshes..."));
+
+		for (auto& MeshPair : SMInstances)
+		{
+			UStaticMesh * Mesh = MeshPair.Key;
+			if (SceneInstances.MeshDuplicates.Contains(Mesh))
+			{
+				continue;
+			}
+			// Materials may change without the mesh, export them separately in case mesh is up to date
+			ExportMeshMaterials(Mesh, ExportPath);
+			ExportStaticMeshFromRenderData(Mesh, ExportPath, MeshComponents);
+		}
+	}
+	if (ContainComponent(SceneComponents, TEXT("SKELETAL_MESH")))
+	{
+		UE_LOG(LogTiXExporter, Log, TEXT("  Skeletal meshes..."));
+		for (auto& MeshPair : SKMActors)
+		{
+			USkeletalMesh* SkeletalMesh = MeshPair.Key;
+			ExportMeshMaterials(SkeletalMesh, ExportPath);
+			ExportSkeletalMeshFromRenderData(SkeletalMesh, ExportPath, MeshComponents);
+		}
+
+		UE_LOG(LogTiXExporter, Log, TEXT("  Related Animations..."));
+		for (auto& AnimPair : RelatedAnimations)
+		{
+			USkeletalMesh* SkeletalMesh = AnimPair.Key;
+			UAnimationAsset* AnimAsset = AnimPair.Value;
+			ExportAnimationAsset(AnimAsset, ExportPath);
+		}
+	}
+}
+
+void UTiXExporterBPLibrary::ExportStaticMeshActor(AStaticMeshActor * StaticMeshActor, FString ExportPath, const TArray<FString>& Components)
+{
+	ExportStaticMesh(StaticMeshActor->GetStaticMeshComponent()->GetStaticMesh(), ExportPath, Components);
+}
+
+void UTiXExporterBPLibrary::ExportStaticMesh(UStaticMesh * StaticMesh, FString ExportPath, const TArray<FString>& Components)
+{
+	ExportStaticMeshFromRenderData(StaticMesh, ExportPath, Components);
+}
+
+void GenerateMeshCluster(const FTiXVertexStreams& InVertices, const TArray<int32>& InIndices, TArray< TSharedPtr<FJsonValue> >& OutJClusters)
+{
+	FTiXMeshCluster MeshCluster(InVertices.Positions, InIndices, 1.f / TiXExporterSetting.MeshVertexPositionScale);
+	MeshCluster.GenerateCluster(TiXExporterSetting.MeshClusterSize);
+
+	TSharedPtr<FJsonObject> JClusters = MakeShareable(new FJsonObject);
+	JClusters->SetNumberField(TEXT("cluster_count"), MeshCluster.Clusters.Num());
+	JClusters->SetNumberField(TEXT("cluster_size"), TiXExporterSetting.MeshClusterSize);
+
+	for (const auto& C : MeshCluster.Clusters)
+	{
+		TArray< TSharedPtr<FJsonValue> > ClusterIndicesArray;
+		ConvertToJsonArray(C, ClusterIndicesArray);
+
+		TSharedRef< FJsonValueArray > JsonValueArray = MakeShareable(new FJsonValueArray(ClusterIndicesArray));
+		OutJClusters.Add(JsonValueArray);
+	}
+}
+
+/** Streams of a render data LOD that are requested, position is required and skin weights are always taken. */
+static uint32 GetRenderDataVsFormat(const FTiXRenderVertexBuffers& Buffers, uint32 RequestedVsFormat)
+{
+	if (Buffers.Positions->GetNumVertices() == 0 || (RequestedVsFormat & EVSSEG_POSITION) == 0)
+	{
+		return 0;
+	}
+
+	uint32 VsFormat = EVSSEG_POSITION;
+	const int32 TotalNumTexCoords = Buffers.StaticMeshVertices->GetNumTexCoords();
+	if (Buffers.StaticMeshVertices->GetNumVertices() > 0)
+	{
+		VsFormat |= RequestedVsFormat & (EVSSEG_NORMAL | EVSSEG_TANGENT);
+	}
+	if (Buffers.Colors->GetNumVertices() > 0)
+	{
+		VsFormat |= RequestedVsFormat & EVSSEG_COLOR;
+	}
+	if (TotalNumTexCoords > 0)
+	{
+		VsFormat |= RequestedVsFormat & EVSSEG_TEXCOORD0;
+	}
+	if (TotalNumTexCoords > 1)
+	{
+		VsFormat |= RequestedVsFormat & EVSSEG_TEXCOORD1;
+	}
+	if (Buffers.SkinWeights != nullptr && Buffers.SkinWeights->GetNumVertices() > 0)
+	{
+		VsFormat |= EVSSEG_BLENDINDEX | EVSSEG_BLENDWEIGHT;
+	}
+	return VsFormat;
+}
+
+/**
+* Gather vertices and indices of render data sections, shared by static and skeletal meshes.
+* IndexStart of InOutSections points to MeshIndices, and is rewritten to OutIndices.
+* MeshIndices is read in place, OutIndices is the only copy of indices.
+*/
+static void GatherRenderVertices(const FTiXRenderVertexBuffers& Buffers, uint32 VsFormat, const FIndexArrayView& MeshIndices, TArray<FTiXMeshSection>& InOutSections, FTiXVertexStreams& OutVertices, TArray<uint32>& OutIndices)
+{
+	// Decode each referenced vertex once, unreferenced vertices are compacted away
+	FTiXVertexStreams DecodedVertices;
+	TArray<uint32> Remap;
+	FTiXVertexDecoder::DecodeReferencedVertices(Buffers, VsFormat, TiXExporterSetting.MeshVertexPositionScale, MeshIndices, DecodedVertices, Remap);
+
+	if (!TiXExporterSetting.bEnableVertexWelding)
+	{
+		// Referenced vertices are kept in render data order
+		OutVertices = MoveTemp(DecodedVertices);
+		OutIndices.SetNumUninitialized(MeshIndices.Num());
+		for (int32 ii = 0; ii < MeshIndices.Num(); ++ii)
+		{
+			OutIndices[ii] = Remap[MeshIndices[ii]];
+		}
+		return;
+	}
+
+	// Welding gathers referenced vertices into a new vertex buffer.
+	// Blend indices are local to the bone map of a section, so skinned vertices only weld within their section.
+	const bool bWeldPerSection = (VsFormat & EVSSEG_BLENDINDEX) != 0;
+	FTiXVertexWelder Welder(VsFormat, MeshIndices.Num(), TiXExporterSetting.VertexWeldEpsilon);
+	OutIndices.Reset(MeshIndices.Num());
+	for (int32 Section = 0; Section < InOutSections.Num(); ++Section)
+	{
+		FTiXMeshSection& TiXSection = InOutSections[Section];
+		const uint32 FirstIndex = TiXSection.IndexStart;
+		const uint32 MaxIndex = FirstIndex + TiXSection.NumTriangles * 3;
+		const uint32 Group = bWeldPerSection ? Section : 0;
+		TiXSection.IndexStart = OutIndices.Num();
+		for (uint32 ii = FirstIndex; ii < MaxIndex; ++ii)
+		{
+			OutIndices.Add(Welder.AddVertex(DecodedVertices, Remap[MeshIndices[ii]], Group));
+		}
+	}
+	OutVertices = MoveTemp(Welder.GetVertices());
+}
+
+/**
+* Remove degenerate and sliver triangles of each section, before indices are optimized or clustered.
+* Sections are packed one after another into the new indices.
+*/
+static void RemoveDegenerateTriangles(const UObject* Mesh, int32 LODIndex, TArray<FTiXMeshSection>& InOutSections, const TArray<FVector>& Positions, TArray<uint32>& InOutIndices)
+{
+	if (!TiXExporterSetting.bRemoveDegenerateTriangles)
+	{
+		return;
+	}
+
+	TArray<uint32> Indices;
+	Indices.Reserve(InOutIndices.Num());
+	FTiXDegenerateStats TotalStats;
+	for (int32 Section = 0; Section < InOutSections.Num(); ++Section)
+	{
+		FTiXMeshSection& TiXSection = InOutSections[Section];
+		const int32 IndexStart = Indices.Num();
+		Indices.Append(InOutIndices.GetData() + TiXSection.IndexStart, TiXSection.NumTriangles * 3);
 
-		// Output tiles
+		FTiXDegenerateStats Stats;
+		const int32 NumIndices = FTiXMeshOptimizer::RemoveDegenerateTriangles(Indices.GetData() + IndexStart, TiXSection.NumTriangles * 3, Positions,
+			TiXExporterSetting.DegenerateAreaThreshold, TiXExporterSetting.SliverAspectThreshold, Stats);
+		Indices.SetNum(IndexStart + NumIndices, false);
+		TiXSection.IndexStart = IndexStart;
+		TiXSection.NumTriangles = NumIndices / 3;
+
+		if (Stats.NumDegenerates > 0 || Stats.NumSlivers > 0)
 		{
-			// Output tile refs to scene
-			TArray< TSharedPtr<FJsonValue> > JTiles;
-			for (const auto& Tile : Tiles)
-			{
-				const FIntPoint& TilePos = Tile.Key;
-				const FTiXSceneTile& SceneTile = Tile.Value;
+			UE_LOG(LogTiXExporter, Log, TEXT("  %s LOD %d section %d: removed %d degenerate and %d sliver triangles."), *Mesh->GetName(), LODIndex, Section, Stats.NumDegenerates, Stats.NumSlivers);
+		}
+		TotalStats.Accumulate(Stats);
+	}
+	if (TotalStats.NumDegenerates > 0 || TotalStats.NumSlivers > 0)
+	{
+		UE_LOG(LogTiXExporter, Log, TEXT("  %s LOD %d: removed %d degenerate and %d sliver triangles in total."), *Mesh->GetName(), LODIndex, TotalStats.NumDegenerates, TotalStats.NumSlivers);
+	}
+	InOutIndices = MoveTemp(Indices);
+}
 
-				ExportSceneTile(SceneTile, CurrentWorld->GetName(), ExportPath);
+/**
+* Reorder triangles of each section for the GPU, before vertex ranges are calculated.
+* Overdraw optimization reorders clusters of the vertex cache order, so it runs the vertex cache pass as well.
+*/
+static void OptimizeSectionIndices(const UObject* Mesh, const TArray<FTiXMeshSection>& Sections, const TArray<FVector>& Positions, TArray<uint32>& InOutIndices)
+{
+	if (!TiXExporterSetting.bEnableVertexCacheOptimization && !TiXExporterSetting.bEnableOverdrawOptimization)
+	{
+		return;
+	}
 
-				// Export tile point position
-				TArray< TSharedPtr<FJsonValue> > JPosition;
-				ConvertToJsonArray(TilePos, JPosition);
-				//FString TilePathName = FString::Printf(TEXT("%s/t%d_%d.tasset"), *CurrentWorld->GetName(), TilePos.X, TilePos.Y);
-				TSharedRef< FJsonValueArray > JsonValue = MakeShareable(new FJsonValueArray(JPosition));
-				JTiles.Add(JsonValue);
-			}
-			JsonObject->SetArrayField(TEXT("tiles"), JTiles);
+	FTiXVertexCacheStats StatsBefore, StatsAfter;
+	for (const FTiXMeshSection& TiXSection : Sections)
+	{
+		uint32* SectionIndices = InOutIndices.GetData() + TiXSection.IndexStart;
+		const int32 NumIndices = TiXSection.NumTriangles * 3;
+		StatsBefore.Accumulate(FTiXMeshOptimizer::CalcVertexCacheStats(SectionIndices, NumIndices));
+		FTiXMeshOptimizer::OptimizeVertexCache(SectionIndices, NumIndices);
+		if (TiXExporterSetting.bEnableOverdrawOptimization && TiXSection.bDepthWrite)
+		{
+			FTiXMeshOptimizer::OptimizeOverdraw(SectionIndices, NumIndices, Positions, TiXExporterSetting.OverdrawCacheThreshold);
 		}
+		StatsAfter.Accumulate(FTiXMeshOptimizer::CalcVertexCacheStats(SectionIndices, NumIndices));
+	}
+	UE_LOG(LogTiXExporter, Log, TEXT("  Vertex cache of %s: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f."), *Mesh->GetName(),
+		StatsBefore.GetACMR(), StatsAfter.GetACMR(), StatsBefore.GetATVR(), StatsAfter.GetATVR());
+}
 
+/** Material index of a skeletal mesh LOD section, LODs may remap materials of their sections. */
+static int32 GetSkeletalSectionMaterialIndex(const USkeletalMesh* SkeletalMesh, int32 LODIndex, int32 Section)
+{
+	const FSkeletalMeshLODInfo* LODInfo = SkeletalMesh->GetLODInfo(LODIndex);
+	if (LODInfo != nullptr && LODInfo->LODMaterialMap.IsValidIndex(Section) && SkeletalMesh->Materials.IsValidIndex(LODInfo->LODMaterialMap[Section]))
+	{
+		return LODInfo->LODMaterialMap[Section];
+	}
+	return SkeletalMesh->GetResourceForRendering()->LODRenderData[LODIndex].RenderSections[Section].MaterialIndex;
+}
 
-		SaveJsonToFile(JsonObject, CurrentWorld->GetName(), ExportPath);
+/** Materials of sections in all LODs, each once. */
+static void GetMeshMaterials(const UStaticMesh* StaticMesh, TArray<UMaterialInterface*>& OutMaterials)
+{
+	for (const FStaticMeshLODResources& LODResource : StaticMesh->RenderData->LODResources)
+	{
+		for (const FStaticMeshSection& MeshSection : LODResource.Sections)
+		{
+			OutMaterials.AddUnique(StaticMesh->StaticMaterials[MeshSection.MaterialIndex].MaterialInterface);
+		}
 	}
-	SMInstances.Empty();
 }
 
-void UTiXExporterBPLibrary::ExportStaticMeshActor(AStaticMeshActor * StaticMeshActor, FString ExportPath, const TArray<FString>& Components)
+static void GetMeshMaterials(const USkeletalMesh* SkeletalMesh, TArray<UMaterialInterface*>& OutMaterials)
 {
-	ExportStaticMesh(StaticMeshActor->GetStaticMeshComponent()->GetStaticMesh(), ExportPath, Components);
+	const FSkeletalMeshRenderData* SKMRenderData = SkeletalMesh->GetResourceForRendering();
+	for (int32 LODIndex = 0; LODIndex < SKMRenderData->LODRenderData.Num(); ++LODIndex)
+	{
+		for (int32 Section = 0; Section < SKMRenderData->LODRenderData[LODIndex].RenderSections.Num(); ++Section)
+		{
+			OutMaterials.AddUnique(SkeletalMesh->Materials[GetSkeletalSectionMaterialIndex(SkeletalMesh, LODIndex, Section)].MaterialInterface);
+		}
+	}
 }
 
-void UTiXExporterBPLibrary::ExportStaticMesh(UStaticMesh * StaticMesh, FString ExportPath, const TArray<FString>& Components)
+/** Lowest and highest vertex referenced by each section, so a section can be drawn with a tight vertex window. */
+static void CalcSectionVertexRanges(TArray<FTiXMeshSection>& InOutSections, const TArray<uint32>& Indices)
 {
-	ExportStaticMeshFromRenderData(StaticMesh, ExportPath, Components);
+	for (FTiXMeshSection& TiXSection : InOutSections)
+	{
+		uint32 MinVertex = MAX_uint32, MaxVertex = 0;
+		const uint32 MaxIndex = TiXSection.IndexStart + TiXSection.NumTriangles * 3;
+		for (uint32 ii = TiXSection.IndexStart; ii < MaxIndex; ++ii)
+		{
+			MinVertex = FMath::Min(MinVertex, Indices[ii]);
+			MaxVertex = FMath::Max(MaxVertex, Indices[ii]);
+		}
+		TiXSection.MinVertex = TiXSection.NumTriangles > 0 ? MinVertex : 0;
+		TiXSection.MaxVertex = MaxVertex;
+	}
 }
 
-void GenerateMeshCluster(const TArray<FTiXVertex>& InVertices, const TArray<int32>& InIndices, TArray< TSharedPtr<FJsonValue> >& OutJClusters)
+/**
+* 16 bit indices address 65536 vertices. Indices of larger meshes are rebased to MinVertex of each section,
+* when every section spans no more than that, otherwise indices stay 32 bit.
+*/
+static void RebaseSectionIndices(TArray<FTiXMeshSection>& InOutSections, TArray<uint32>& InOutIndices, int32 NumVertices)
 {
-	FTiXMeshCluster MeshCluster(InVertices, InIndices, 1.f / TiXExporterSetting.MeshVertexPositionScale);
-	MeshCluster.GenerateCluster(TiXExporterSetting.MeshClusterSize);
+	const uint32 MaxVertices16 = MAX_uint16 + 1;
+	if ((uint32)NumVertices <= MaxVertices16)
+	{
+		return;
+	}
+	for (const FTiXMeshSection& TiXSection : InOutSections)
+	{
+		if (TiXSection.MaxVertex - TiXSection.MinVertex >= MaxVertices16)
+		{
+			return;
+		}
+	}
 
-	TSharedPtr<FJsonObject> JClusters = MakeShareable(new FJsonObject);
-	JClusters->SetNumberField(TEXT("cluster_count"), MeshCluster.Clusters.Num());
-	JClusters->SetNumberField(TEXT("cluster_size"), TiXExporterSetting.MeshClusterSize);
+	for (FTiXMeshSection& TiXSection : InOutSections)
+	{
+		TiXSection.BaseVertex = TiXSection.MinVertex;
+		const uint32 MaxIndex = TiXSection.IndexStart + TiXSection.NumTriangles * 3;
+		for (uint32 ii = TiXSection.IndexStart; ii < MaxIndex; ++ii)
+		{
+			InOutIndices[ii] -= TiXSection.BaseVertex;
+		}
+	}
+}
 
-	for (const auto& C : MeshCluster.Clusters)
+/** LOD0 of a mesh that generated LODs are simplified from. */
+struct FTiXLODSource
+{
+	const UObject* Mesh;
+	FTiXRenderVertexBuffers Buffers;
+	FIndexArrayView Indices;
+	TArray<FTiXMeshSection> Sections;
+	// Render LODs of the mesh, and screen size and triangle count of the last one
+	int32 NumLODs;
+	float ScreenSize;
+	int32 NumLastLODTriangles;
+
+	FTiXLODSource()
+		: Mesh(nullptr)
+		, NumLODs(0)
+		, ScreenSize(0.f)
+		, NumLastLODTriangles(0)
+	{}
+};
+
+/** Get LOD0 of a mesh, false if the mesh has enough render LODs already. */
+static bool GetLODSource(UStaticMesh* StaticMesh, FTiXLODSource& OutSource)
+{
+	const int32 NumLODs = StaticMesh->RenderData->LODResources.Num();
+	if (NumLODs >= TiXExporterSetting.TargetMeshLODs)
 	{
-		TArray< TSharedPtr<FJsonValue> > ClusterIndicesArray;
-		ConvertToJsonArray(C, ClusterIndicesArray);
+		return false;
+	}
 
-		TSharedRef< FJsonValueArray > JsonValueArray = MakeShareable(new FJsonValueArray(ClusterIndicesArray));
-		OutJClusters.Add(JsonValueArray);
+	FStaticMeshLODResources& LODResource = StaticMesh->RenderData->LODResources[0];
+	OutSource.Mesh = StaticMesh;
+	OutSource.Buffers.Positions = &LODResource.VertexBuffers.PositionVertexBuffer;
+	OutSource.Buffers.StaticMeshVertices = &LODResource.VertexBuffers.StaticMeshVertexBuffer;
+	OutSource.Buffers.Colors = &LODResource.VertexBuffers.ColorVertexBuffer;
+	OutSource.Indices = LODResource.IndexBuffer.GetArrayView();
+	for (const FStaticMeshSection& MeshSection : LODResource.Sections)
+	{
+		FTiXMeshSection& TiXSection = OutSource.Sections.AddDefaulted_GetRef();
+		TiXSection.NumTriangles = MeshSection.NumTriangles;
+		TiXSection.IndexStart = MeshSection.FirstIndex;
 	}
+	OutSource.NumLODs = NumLODs;
+	OutSource.ScreenSize = StaticMesh->RenderData->ScreenSize[NumLODs - 1].Default;
+	OutSource.NumLastLODTriangles = StaticMesh->RenderData->LODResources[NumLODs - 1].GetNumTriangles();
+	return true;
 }
 
-void UTiXExporterBPLibrary::ExportStaticMeshFromRenderData(UStaticMesh* StaticMesh, const FString& InExportPath, const TArray<FString>& Components)
+static bool GetLODSource(USkeletalMesh* SkeletalMesh, FTiXLODSource& OutSource)
 {
-	FString SMPath = GetResourcePath(StaticMesh);
-	FString ExportPath = InExportPath;
-	ExportPath.ReplaceInline(TEXT("\\"), TEXT("/"));
-	if (ExportPath[ExportPath.Len() - 1] != '/')
-		ExportPath.AppendChar('/');
-	FString ExportFullPath = ExportPath + SMPath;
+	FSkeletalMeshRenderData* SKMRenderData = SkeletalMesh->GetResourceForRendering();
+	const int32 NumLODs = SKMRenderData->LODRenderData.Num();
+	if (NumLODs >= TiXExporterSetting.TargetMeshLODs)
+	{
+		return false;
+	}
 
-	const int32 TotalLODs = StaticMesh->RenderData->LODResources.Num();
+	FSkeletalMeshLODRenderData& LODResource = SKMRenderData->LODRenderData[0];
+	OutSource.Mesh = SkeletalMesh;
+	OutSource.Buffers.Positions = &LODResource.StaticVertexBuffers.PositionVertexBuffer;
+	OutSource.Buffers.StaticMeshVertices = &LODResource.StaticVertexBuffers.StaticMeshVertexBuffer;
+	OutSource.Buffers.Colors = &LODResource.StaticVertexBuffers.ColorVertexBuffer;
+	OutSource.Buffers.SkinWeights = &LODResource.SkinWeightVertexBuffer;
+	FRawStaticIndexBuffer16or32Interface* IndexBuffer = LODResource.MultiSizeIndexContainer.GetIndexBuffer();
+	OutSource.Indices = FIndexArrayView(IndexBuffer->Num() > 0 ? IndexBuffer->GetPointerTo(0) : nullptr, IndexBuffer->Num(), IndexBuffer->GetDataTypeSize() == sizeof(uint32));
+	for (const FSkelMeshRenderSection& MeshSection : LODResource.RenderSections)
+	{
+		FTiXMeshSection& TiXSection = OutSource.Sections.AddDefaulted_GetRef();
+		TiXSection.NumTriangles = MeshSection.NumTriangles;
+		TiXSection.IndexStart = MeshSection.BaseIndex;
+		TiXSection.BoneMap.Append(MeshSection.BoneMap);
+	}
+	OutSource.NumLODs = NumLODs;
+	const FSkeletalMeshLODInfo* LODInfo = SkeletalMesh->GetLODInfo(NumLODs - 1);
+	OutSource.ScreenSize = LODInfo != nullptr ? LODInfo->ScreenSize.Default : 0.f;
+	OutSource.NumLastLODTriangles = SKMRenderData->LODRenderData[NumLODs - 1].GetTotalFaces();
+	return true;
+}
 
-	// Export LOD0 only for now.
-	int32 CurrentLOD = 0;
-	FStaticMeshLODResources& LODResource = StaticMesh->RenderData->LODResources[CurrentLOD];
+/**
+* Simplify LOD0 into LODs after the render LODs of a mesh, up to TargetMeshLODs.
+* Each LOD aims at LODTriangleRatio of the triangles of the LOD before it, starting from the last render LOD,
+* so generated LODs are always coarser than render LODs. The chain ends early
+* when LODMaxError keeps a LOD from getting notably coarser. Thread safe, only reads render data.
+*/
+static void GenerateMeshLODs(const FTiXLODSource& Source, uint32 RequestedVsFormat, TArray<FTiXGeneratedLOD>& OutLODs)
+{
+	const uint32 VsFormat = GetRenderDataVsFormat(Source.Buffers, RequestedVsFormat);
+	if ((VsFormat & EVSSEG_POSITION) == 0)
+	{
+		return;
+	}
 
-	const FStaticMeshVertexBuffer& StaticMeshVertexBuffer = LODResource.VertexBuffers.StaticMeshVertexBuffer;
-	const FPositionVertexBuffer& PositionVertexBuffer = LODResource.VertexBuffers.PositionVertexBuffer;
-	const FColorVertexBuffer& ColorVertexBuffer = LODResource.VertexBuffers.ColorVertexBuffer;
-	const int32 TotalNumTexCoords = LODResource.VertexBuffers.StaticMeshVertexBuffer.GetNumTexCoords();
+	FTiXVertexStreams Vertices;
+	TArray<uint32> Indices;
+	TArray<FTiXMeshSection> Sections = Source.Sections;
+	GatherRenderVertices(Source.Buffers, VsFormat, Source.Indices, Sections, Vertices, Indices);
 
-	// Get Vertex format
-	uint32 VsFormat = 0;
-	if (PositionVertexBuffer.GetNumVertices() > 0 && ContainComponent(Components, (TEXT("POSITION"))))
+	// Every LOD is simplified from LOD0, so errors do not add up along the chain
+	const float Ratio = TiXExporterSetting.LODTriangleRatio;
+	const int32 NumTriangles0 = Indices.Num() / 3;
+	int32 LastNumTriangles = Source.NumLODs > 1 ? FMath::Min(Source.NumLastLODTriangles, NumTriangles0) : NumTriangles0;
+	float ScreenSize = Source.ScreenSize;
+	for (int32 LODIndex = Source.NumLODs; LODIndex < TiXExporterSetting.TargetMeshLODs; ++LODIndex)
 	{
-		VsFormat |= EVSSEG_POSITION;
+		const int32 TargetTriangles = FMath::FloorToInt(LastNumTriangles * Ratio);
+		FTiXGeneratedLOD LOD;
+		FTiXMeshSimplifier::Simplify(Vertices, Indices, Sections, TargetTriangles, TiXExporterSetting.LODMaxError, LOD.Indices, LOD.Sections);
+		const int32 NumTriangles = LOD.Indices.Num() / 3;
+		if (NumTriangles == 0 || NumTriangles > LastNumTriangles * 0.9f)
+		{
+			break;
+		}
+
+		// Keep vertices of this LOD only
+		LOD.Vertices = Vertices;
+		FTiXMeshOptimizer::OptimizeVertexFetch(LOD.Indices, LOD.Vertices);
+
+		// Screen size follows the radius a triangle covers on screen
+		ScreenSize *= FMath::Sqrt(Ratio);
+		LOD.ScreenSize = ScreenSize;
+		LastNumTriangles = NumTriangles;
+		OutLODs.Add(MoveTemp(LOD));
 	}
-	else
+}
+
+/** LODs generated for a mesh before export, or generated now for meshes exported on their own. */
+template<typename TMesh>
+static const TArray<FTiXGeneratedLOD>& GetGeneratedMeshLODs(TMesh* Mesh, const TArray<FString>& Components, TArray<FTiXGeneratedLOD>& OutLocalLODs)
+{
+	if (TiXExporterSetting.bEnableLODGeneration)
 	{
-		UE_LOG(LogTiXExporter, Error, TEXT("Static mesh [%s] do not have position stream."), *StaticMesh->GetPathName());
-		return;
+		if (const TArray<FTiXGeneratedLOD>* GeneratedLODs = FTiXExportSession::Get().FindGeneratedLODs(Mesh))
+		{
+			return *GeneratedLODs;
+		}
+		FTiXLODSource Source;
+		if (GetLODSource(Mesh, Source))
+		{
+			GenerateMeshLODs(Source, GetRequestedVsFormat(Components), OutLocalLODs);
+		}
 	}
-	if (StaticMeshVertexBuffer.GetNumVertices() > 0)
+	return OutLocalLODs;
+}
+
+void UTiXExporterBPLibrary::GenerateSceneMeshLODs(const FTiXSceneInstances& SceneInstances, const TArray<FString>& MeshComponents)
+{
+	UE_LOG(LogTiXExporter, Log, TEXT("  Mesh LOD generation..."));
+	FTiXExportSession& Session = FTiXExportSession::Get();
+
+	// Collect meshes on game thread, simplifying only reads their render data and runs in parallel
+	TArray<FTiXLODSource> Sources;
+	for (const auto& MeshPair : SceneInstances.SMInstances)
 	{
-		if (ContainComponent(Components, (TEXT("NORMAL"))))
-			VsFormat |= EVSSEG_NORMAL;
-		if (ContainComponent(Components, (TEXT("TANGENT"))))
-			VsFormat |= EVSSEG_TANGENT;
+		FTiXLODSource Source;
+		if (!SceneInstances.MeshDuplicates.Contains(MeshPair.Key) &&
+			!Session.IsAssetUpToDate(MeshPair.Key) &&
+			GetLODSource(MeshPair.Key, Source))
+		{
+			Sources.Add(MoveTemp(Source));
+		}
 	}
-	if (ColorVertexBuffer.GetNumVertices() > 0 && ContainComponent(Components, (TEXT("COLOR"))))
+	for (const auto& MeshPair : SceneInstances.SKMActors)
 	{
-		VsFormat |= EVSSEG_COLOR;
+		FTiXLODSource Source;
+		if (!Session.IsAssetUpToDate(MeshPair.Key) && GetLODSource(MeshPair.Key, Source))
+		{
+			Sources.Add(MoveTemp(Source));
+		}
 	}
-	if (TotalNumTexCoords > 0 && ContainComponent(Components, (TEXT("TEXCOORD0"))))
+
+	const uint32 RequestedVsFormat = GetRequestedVsFormat(MeshComponents);
+	TArray< TArray<FTiXGeneratedLOD> > GeneratedLODs;
+	GeneratedLODs.SetNum(Sources.Num());
+	ParallelFor(Sources.Num(), [&](int32 Index)
+	{
+		GenerateMeshLODs(Sources[Index], RequestedVsFormat, GeneratedLODs[Index]);
+	});
+
+	int32 TotalGeneratedLODs = 0;
+	for (int32 Index = 0; Index < Sources.Num(); ++Index)
 	{
-		VsFormat |= EVSSEG_TEXCOORD0;
+		UE_LOG(LogTiXExporter, Log, TEXT("  %s: %d render LODs, %d generated LODs."), *Sources[Index].Mesh->GetName(), Sources[Index].NumLODs, GeneratedLODs[Index].Num());
+		TotalGeneratedLODs += GeneratedLODs[Index].Num();
+		Session.SetGeneratedLODs(Sources[Index].Mesh, MoveTemp(GeneratedLODs[Index]));
 	}
-	if (TotalNumTexCoords > 1 && ContainComponent(Components, (TEXT("TEXCOORD1"))))
+	UE_LOG(LogTiXExporter, Log, TEXT("  %d LODs are generated for %d meshes."), TotalGeneratedLODs, Sources.Num());
+}
+
+TSharedPtr<FJsonObject> UTiXExporterBPLibrary::ExportStaticMeshLOD(UStaticMesh* StaticMesh, int32 LODIndex, const FTiXGeneratedLOD* GeneratedLOD, const FString& InExportPath, const TArray<FString>& Components)
+{
+	// Generated LODs use sections and materials of LOD0
+	const int32 RenderLODIndex = GeneratedLOD != nullptr ? 0 : LODIndex;
+	FStaticMeshLODResources& LODResource = StaticMesh->RenderData->LODResources[RenderLODIndex];
+
+	const FStaticMeshVertexBuffer& StaticMeshVertexBuffer = LODResource.VertexBuffers.StaticMeshVertexBuffer;
+	const FPositionVertexBuffer& PositionVertexBuffer = LODResource.VertexBuffers.PositionVertexBuffer;
+	const FColorVertexBuffer& ColorVertexBuffer = LODResource.VertexBuffers.ColorVertexBuffer;
+	const int32 TotalNumTexCoords = LODResource.VertexBuffers.StaticMeshVertexBuffer.GetNumTexCoords();
+
+	FTiXRenderVertexBuffers RenderVertexBuffers;
+	RenderVertexBuffers.Positions = &PositionVertexBuffer;
+	RenderVertexBuffers.StaticMeshVertices = &StaticMeshVertexBuffer;
+	RenderVertexBuffers.Colors = &ColorVertexBuffer;
+
+	// Get Vertex format
+	const uint32 VsFormat = GetRenderDataVsFormat(RenderVertexBuffers, GetRequestedVsFormat(Components));
+	if ((VsFormat & EVSSEG_POSITION) == 0)
 	{
-		VsFormat |= EVSSEG_TEXCOORD1;
+		UE_LOG(LogTiXExporter, Error, TEXT("Static mesh [%s] LOD %d do not have position stream."), *StaticMesh->GetPathName(), LODIndex);
+		return nullptr;
 	}
 
-	TArray<uint32> MeshIndices;
-	LODResource.IndexBuffer.GetCopy(MeshIndices);
+	const FIndexArrayView MeshIndices = LODResource.IndexBuffer.GetArrayView();
 
-#define RE_GATHER_VERTEX 0
-	// data container
-#if RE_GATHER_VERTEX
-	TArray<FTiXVertex> VertexData;
-	TArray<int32> IndexData;
-	TMap<FTiXVertex, int32> IndexMap;
-
-	VertexData.Empty(LODResource.VertexBuffers.PositionVertexBuffer.GetNumVertices());
-#else
-	TArray<FTiXVertex> VertexData;
-	TArray<uint32> IndexData = MeshIndices;
-
-	VertexData.AddZeroed(LODResource.VertexBuffers.PositionVertexBuffer.GetNumVertices());
-#endif
 	TArray<FTiXMeshSection> MeshSections;
-
-	TArray< TSharedPtr<FJsonValue> > JsonSections;
+	TArray<FString> MaterialInstancePathNames, MaterialSlotNames;
 	for (int32 Section = 0; Section < LODResource.Sections.Num(); ++Section)
 	{
 		FStaticMeshSection& MeshSection = LODResource.Sections[Section];
 
-		const int32 TotalFaces = MeshSection.NumTriangles;
-		const int32 MinVertexIndex = MeshSection.MinVertexIndex;
-		const int32 MaxVertexIndex = MeshSection.MaxVertexIndex;
-		const int32 FirstIndex = MeshSection.FirstIndex;
-
 		// Remember this section
 		FTiXMeshSection TiXSection;
 		TiXSection.NumTriangles = MeshSection.NumTriangles;
-#if RE_GATHER_VERTEX
-		TiXSection.IndexStart = IndexData.Num();
-#else
-		TiXSection.IndexStart = FirstIndex;
-#endif
-		MeshSections.Add(TiXSection);
+		TiXSection.IndexStart = MeshSection.FirstIndex;
 
 		// Dump section name and material
-		FString MaterialInstancePathName, MaterialSlotName;
-
 		if (TiXExporterSetting.bIgnoreMaterial)
 		{
-			MaterialInstancePathName = TEXT("DebugMaterial");
-			MaterialSlotName = TEXT("DebugMaterialName");
+			MaterialInstancePathNames.Add(TEXT("DebugMaterial"));
+			MaterialSlotNames.Add(TEXT("DebugMaterialName"));
 		}
 		else
 		{
-			MaterialInstancePathName = GetResourcePath(StaticMesh->StaticMaterials[MeshSection.MaterialIndex].MaterialInterface);
-			MaterialInstancePathName += StaticMesh->StaticMaterials[MeshSection.MaterialIndex].MaterialInterface->GetName();
-			MaterialSlotName = StaticMesh->StaticMaterials[MeshSection.MaterialIndex].MaterialSlotName.ToString();
-			ExportMaterialInstance(StaticMesh->StaticMaterials[MeshSection.MaterialIndex].MaterialInterface, InExportPath);
+			UMaterialInterface* MaterialInterface = GetExportedMaterial(StaticMesh->StaticMaterials[MeshSection.MaterialIndex].MaterialInterface);
+			TiXSection.bDepthWrite = MaterialInterface == nullptr || IsDepthWriteBlendMode(MaterialInterface->GetBlendMode());
+			MaterialInstancePathNames.Add(GetResourcePathName(MaterialInterface));
+			MaterialSlotNames.Add(StaticMesh->StaticMaterials[MeshSection.MaterialIndex].MaterialSlotName.ToString());
+			ExportMaterialInstance(MaterialInterface, InExportPath);
 		}
+		MeshSections.Add(TiXSection);
+	}
 
-		// Collect vertices and indices
-		const int32 MaxIndex = FirstIndex + TotalFaces * 3;
-		for (int32 ii = FirstIndex; ii < MaxIndex; ++ii)
+	// data container
+	FTiXVertexStreams VertexData;
+	TArray<uint32> IndexData;
+	if (GeneratedLOD != nullptr)
+	{
+		VertexData = GeneratedLOD->Vertices;
+		IndexData = GeneratedLOD->Indices;
+		for (int32 Section = 0; Section < MeshSections.Num(); ++Section)
 		{
-			uint32 Index = MeshIndices[ii];
-			check(Index < (uint32)VertexData.Num());
-
-			FTiXVertex Vertex;
-			Vertex.Position = PositionVertexBuffer.VertexPosition(Index) * TiXExporterSetting.MeshVertexPositionScale;
-			if ((VsFormat & EVSSEG_NORMAL) != 0)
-			{
-				Vertex.Normal = StaticMeshVertexBuffer.VertexTangentZ(Index).GetSafeNormal();
-			}
-			if ((VsFormat & EVSSEG_TANGENT) != 0)
-			{
-				Vertex.TangentX = StaticMeshVertexBuffer.VertexTangentX(Index).GetSafeNormal();
-			}
-			if ((VsFormat & EVSSEG_TEXCOORD0) != 0)
-			{
-				Vertex.TexCoords[0] = StaticMeshVertexBuffer.GetVertexUV(Index, 0);
-			}
-			if ((VsFormat & EVSSEG_TEXCOORD1) != 0)
-			{
-				Vertex.TexCoords[1] = StaticMeshVertexBuffer.GetVertexUV(Index, 1);
-			}
-			if ((VsFormat & EVSSEG_COLOR) != 0)
-			{
-				FColor C = ColorVertexBuffer.VertexColor(Index);
-				const float OneOver255 = 1.f / 255.f;
-				Vertex.Color.X = C.R * OneOver255;
-				Vertex.Color.Y = C.G * OneOver255;
-				Vertex.Color.Z = C.B * OneOver255;
-				Vertex.Color.W = C.A * OneOver255;
-			}
-
-#if RE_GATHER_VERTEX
-			// gather vertices and indices
-			int32 * VertexIndex = IndexMap.Find(Vertex);
-			if (VertexIndex == nullptr)
-			{
-				// Add a new vertex to vertex buffer
-				VertexData.Add(Vertex);
-				int32 CurrentIndex = VertexData.Num() - 1;
-				IndexData.Add(CurrentIndex);
-				IndexMap.Add(Vertex, CurrentIndex);
-			}
-			else
-			{
-				// Add an exist vertex's index
-				IndexData.Add(*VertexIndex);
-			}
-#else
-			VertexData[Index] = Vertex;
-#endif
+			MeshSections[Section].IndexStart = GeneratedLOD->Sections[Section].IndexStart;
+			MeshSections[Section].NumTriangles = GeneratedLOD->Sections[Section].NumTriangles;
 		}
+	}
+	else
+	{
+		GatherRenderVertices(RenderVertexBuffers, VsFormat, MeshIndices, MeshSections, VertexData, IndexData);
+	}
+
+	// Finish indices, sections are saved with their final ranges
+	RemoveDegenerateTriangles(StaticMesh, LODIndex, MeshSections, VertexData.Positions, IndexData);
+	OptimizeSectionIndices(StaticMesh, MeshSections, VertexData.Positions, IndexData);
+	if (TiXExporterSetting.bEnableVertexFetchOptimization)
+	{
+		FTiXMeshOptimizer::OptimizeVertexFetch(IndexData, VertexData);
+	}
+	CalcSectionVertexRanges(MeshSections, IndexData);
+	RebaseSectionIndices(MeshSections, IndexData, VertexData.Num());
 
-		TSharedPtr<FJsonObject> JSection = SaveMeshSectionToJson(TiXSection, MaterialSlotName, MaterialInstancePathName + ExtName);
+	TArray< TSharedPtr<FJsonValue> > JsonSections;
+	for (int32 Section = 0; Section < MeshSections.Num(); ++Section)
+	{
+		TSharedPtr<FJsonObject> JSection = SaveMeshSectionToJson(MeshSections[Section], MaterialSlotNames[Section], MaterialInstancePathNames[Section] + ExtName);
 
 		// Disable mesh cluster generate in UE4. Make this happen in converter.
 		if (false && TiXExporterSetting.bEnableMeshCluster)
@@ -800,7 +1903,52 @@ void UTiXExporterBPLibrary::ExportStaticMeshFromRenderData(UStaticMesh* StaticMe
 	}
 
 	// Export mesh data
-	TSharedPtr<FJsonObject> JMeshData = SaveMeshDataToJson(VertexData, IndexData, VsFormat);
+	TSharedPtr<FJsonObject> JMeshData = SaveMeshDataToJson(VertexData, IndexData);
+
+	// output lod
+	TSharedPtr<FJsonObject> JLOD = MakeShareable(new FJsonObject);
+	JLOD->SetNumberField(TEXT("lod"), LODIndex);
+	JLOD->SetNumberField(TEXT("screen_size"), GeneratedLOD != nullptr ? GeneratedLOD->ScreenSize : StaticMesh->RenderData->ScreenSize[LODIndex].Default);
+	JLOD->SetNumberField(TEXT("vertex_count_total"), VertexData.Num());
+	JLOD->SetNumberField(TEXT("index_count_total"), IndexData.Num());
+	JLOD->SetNumberField(TEXT("texcoord_count"), TotalNumTexCoords);
+	JLOD->SetObjectField(TEXT("data"), JMeshData);
+	JLOD->SetArrayField(TEXT("sections"), JsonSections);
+	return JLOD;
+}
+
+void UTiXExporterBPLibrary::ExportStaticMeshFromRenderData(UStaticMesh* StaticMesh, const FString& InExportPath, const TArray<FString>& Components)
+{
+	FTiXScopedAssetExport ScopedExport(StaticMesh);
+	if (!ScopedExport.ShouldExport())
+	{
+		return;
+	}
+
+	const FString ExportFullPath = GetResourceExportPath(StaticMesh, InExportPath);
+
+	// Generated LODs are coarser than all render LODs
+	TArray<FTiXGeneratedLOD> LocalLODs;
+	const TArray<FTiXGeneratedLOD>& GeneratedLODs = GetGeneratedMeshLODs(StaticMesh, Components, LocalLODs);
+	const int32 RenderLODs = StaticMesh->RenderData->LODResources.Num();
+	const int32 TotalLODs = RenderLODs + GeneratedLODs.Num();
+	const int32 TotalNumTexCoords = StaticMesh->RenderData->LODResources[0].VertexBuffers.StaticMeshVertexBuffer.GetNumTexCoords();
+
+	// Coarse LODs go first, so they can be loaded before finer ones
+	TArray< TSharedPtr<FJsonValue> > JLODs;
+	int32 TotalVertices = 0, TotalIndices = 0;
+	for (int32 LODIndex = TotalLODs - 1; LODIndex >= 0; --LODIndex)
+	{
+		const FTiXGeneratedLOD* GeneratedLOD = LODIndex >= RenderLODs ? &GeneratedLODs[LODIndex - RenderLODs] : nullptr;
+		TSharedPtr<FJsonObject> JLOD = ExportStaticMeshLOD(StaticMesh, LODIndex, GeneratedLOD, InExportPath, Components);
+		if (!JLOD.IsValid())
+		{
+			return;
+		}
+		TotalVertices += JLOD->GetIntegerField(TEXT("vertex_count_total"));
+		TotalIndices += JLOD->GetIntegerField(TEXT("index_count_total"));
+		JLODs.Add(MakeShareable(new FJsonValueObject(JLOD)));
+	}
 
 	// Export collision infos
 	TSharedPtr<FJsonObject> JCollisions = ExportMeshCollisions(StaticMesh);
@@ -814,45 +1962,29 @@ void UTiXExporterBPLibrary::ExportStaticMeshFromRenderData(UStaticMesh* StaticMe
 		JsonObject->SetStringField(TEXT("type"), TEXT("static_mesh"));
 		JsonObject->SetNumberField(TEXT("version"), 1);
 		JsonObject->SetStringField(TEXT("desc"), TEXT("Static mesh (Render Resource) from TiX exporter."));
-		JsonObject->SetNumberField(TEXT("vertex_count_total"), VertexData.Num());
-			//LODResource.VertexBuffers.PositionVertexBuffer.GetNumVertices());
-		JsonObject->SetNumberField(TEXT("index_count_total"), IndexData.Num());
-			//MeshIndices.Num());
+		JsonObject->SetNumberField(TEXT("vertex_count_total"), TotalVertices);
+		JsonObject->SetNumberField(TEXT("index_count_total"), TotalIndices);
 		JsonObject->SetNumberField(TEXT("texcoord_count"), TotalNumTexCoords);
-		JsonObject->SetNumberField(TEXT("total_lod"), 1);
-
-		// output mesh data
-		JsonObject->SetObjectField(TEXT("data"), JMeshData);
+		JsonObject->SetNumberField(TEXT("total_lod"), TotalLODs);
 
-		// output mesh sections
-		JsonObject->SetArrayField(TEXT("sections"), JsonSections);
+		// output mesh data and sections of each lod
+		JsonObject->SetArrayField(TEXT("lods"), JLODs);
 
 		// output mesh collisions
 		JsonObject->SetObjectField(TEXT("collisions"), JCollisions);
 
-		SaveJsonToFile(JsonObject, StaticMesh->GetName(), ExportFullPath);
+		if (SaveJsonToFile(JsonObject, StaticMesh->GetName(), ExportFullPath))
+		{
+			ScopedExport.MarkSucceeded();
+		}
 	}
 }
 
-void UTiXExporterBPLibrary::ExportSkeletalMeshFromRenderData(USkeletalMesh* SkeletalMesh, FString InExportPath, const TArray<FString>& Components)
+TSharedPtr<FJsonObject> UTiXExporterBPLibrary::ExportSkeletalMeshLOD(USkeletalMesh* SkeletalMesh, int32 LODIndex, const FTiXGeneratedLOD* GeneratedLOD, const FString& InExportPath, const TArray<FString>& Components)
 {
-	FString SMPath = GetResourcePath(SkeletalMesh);
-	FString ExportPath = InExportPath;
-	ExportPath.ReplaceInline(TEXT("\\"), TEXT("/"));
-	if (ExportPath[ExportPath.Len() - 1] != '/')
-		ExportPath.AppendChar('/');
-	FString ExportFullPath = ExportPath + SMPath;
-
-	FSkeletalMeshRenderData* SKMRenderData = SkeletalMesh->GetResourceForRendering();
-	const int32 TotalLODs = SKMRenderData->LODRenderData.Num();
-
-	USkeleton* Skeleton = SkeletalMesh->Skeleton;
-	FString SkeletonPath = GetResourcePath(Skeleton) + Skeleton->GetName() + TEXT(".tasset");
-	ExportSkeleton(Skeleton, InExportPath);
-
-	// Export LOD0 only for now.
-	int32 CurrentLOD = 0;
-	FSkeletalMeshLODRenderData& LODResource = SKMRenderData->LODRenderData[CurrentLOD];
+	// Generated LODs use sections and materials of LOD0
+	const int32 RenderLODIndex = GeneratedLOD != nullptr ? 0 : LODIndex;
+	FSkeletalMeshLODRenderData& LODResource = SkeletalMesh->GetResourceForRendering()->LODRenderData[RenderLODIndex];
 
 	const FStaticMeshVertexBuffer& StaticMeshVertexBuffer = LODResource.StaticVertexBuffers.StaticMeshVertexBuffer;
 	const FPositionVertexBuffer& PositionVertexBuffer = LODResource.StaticVertexBuffers.PositionVertexBuffer;
@@ -860,166 +1992,155 @@ void UTiXExporterBPLibrary::ExportSkeletalMeshFromRenderData(USkeletalMesh* Skel
 	const FSkinWeightVertexBuffer& SkinWeightVertexBuffer = LODResource.SkinWeightVertexBuffer;
 	const int32 TotalNumTexCoords = LODResource.StaticVertexBuffers.StaticMeshVertexBuffer.GetNumTexCoords();
 
+	FTiXRenderVertexBuffers RenderVertexBuffers;
+	RenderVertexBuffers.Positions = &PositionVertexBuffer;
+	RenderVertexBuffers.StaticMeshVertices = &StaticMeshVertexBuffer;
+	RenderVertexBuffers.Colors = &ColorVertexBuffer;
+	RenderVertexBuffers.SkinWeights = &SkinWeightVertexBuffer;
+
 	// Get Vertex format
-	uint32 VsFormat = 0;
-	if (PositionVertexBuffer.GetNumVertices() > 0 && ContainComponent(Components, (TEXT("POSITION"))))
-	{
-		VsFormat |= EVSSEG_POSITION;
-	}
-	else
-	{
-		UE_LOG(LogTiXExporter, Error, TEXT("Skeletal mesh [%s] do not have position stream."), *SkeletalMesh->GetPathName());
-		return;
-	}
-	if (StaticMeshVertexBuffer.GetNumVertices() > 0)
-	{
-		if (ContainComponent(Components, (TEXT("NORMAL"))))
-			VsFormat |= EVSSEG_NORMAL;
-		if (ContainComponent(Components, (TEXT("TANGENT"))))
-			VsFormat |= EVSSEG_TANGENT;
-	}
-	if (ColorVertexBuffer.GetNumVertices() > 0 && ContainComponent(Components, (TEXT("COLOR"))))
-	{
-		VsFormat |= EVSSEG_COLOR;
-	}
-	if (TotalNumTexCoords > 0 && ContainComponent(Components, (TEXT("TEXCOORD0"))))
+	const uint32 VsFormat = GetRenderDataVsFormat(RenderVertexBuffers, GetRequestedVsFormat(Components));
+	if ((VsFormat & EVSSEG_POSITION) == 0)
 	{
-		VsFormat |= EVSSEG_TEXCOORD0;
+		UE_LOG(LogTiXExporter, Error, TEXT("Skeletal mesh [%s] LOD %d do not have position stream."), *SkeletalMesh->GetPathName(), LODIndex);
+		return nullptr;
 	}
-	if (TotalNumTexCoords > 1 && ContainComponent(Components, (TEXT("TEXCOORD1"))))
+	if ((VsFormat & EVSSEG_BLENDINDEX) == 0)
 	{
-		VsFormat |= EVSSEG_TEXCOORD1;
+		UE_LOG(LogTiXExporter, Error, TEXT("Skeletal mesh [%s] LOD %d do not have Bone Index & Weight stream."), *SkeletalMesh->GetPathName(), LODIndex);
+		return nullptr;
 	}
-	if (SkinWeightVertexBuffer.GetNumVertices() > 0)
+	if (SkinWeightVertexBuffer.GetMaxBoneInfluences() > 4)
 	{
-		VsFormat |= EVSSEG_BLENDINDEX;
-		VsFormat |= EVSSEG_BLENDWEIGHT;
-
-		if (SkinWeightVertexBuffer.GetMaxBoneInfluences() > 4)
-		{
-			UE_LOG(LogTiXExporter, Warning, TEXT("Skeletal mesh [%s] have max bone influences > 4."), *SkeletalMesh->GetPathName());
-		}
-	}
-	else
-	{
-		UE_LOG(LogTiXExporter, Error, TEXT("Skeletal mesh [%s] do not have Bone Index & Weight stream."), *SkeletalMesh->GetPathName());
-		return;
+		UE_LOG(LogTiXExporter, Warning, TEXT("Skeletal mesh [%s] LOD %d have max bone influences > 4."), *SkeletalMesh->GetPathName(), LODIndex);
 	}
 
-	TArray<uint32> MeshIndices;
-	LODResource.MultiSizeIndexContainer.GetIndexBuffer(MeshIndices);
-
-	// data container
-	TArray<FTiXVertex> VertexData;
-	TArray<uint32> IndexData = MeshIndices;
-
-	VertexData.AddZeroed(LODResource.StaticVertexBuffers.PositionVertexBuffer.GetNumVertices());
+	FRawStaticIndexBuffer16or32Interface* IndexBuffer = LODResource.MultiSizeIndexContainer.GetIndexBuffer();
+	const FIndexArrayView MeshIndices(IndexBuffer->Num() > 0 ? IndexBuffer->GetPointerTo(0) : nullptr, IndexBuffer->Num(), IndexBuffer->GetDataTypeSize() == sizeof(uint32));
 
 	TArray<FTiXMeshSection> MeshSections;
-
-	TArray< TSharedPtr<FJsonValue> > JsonSections;
+	TArray<FString> MaterialInstancePathNames, MaterialSlotNames;
 	for (int32 Section = 0; Section < LODResource.RenderSections.Num(); ++Section)
 	{
 		FSkelMeshRenderSection& MeshSection = LODResource.RenderSections[Section];
 
-		const int32 TotalFaces = MeshSection.NumTriangles;
-		//const int32 MinVertexIndex = MeshSection.MinVertexIndex;
-		//const int32 MaxVertexIndex = MeshSection.MaxVertexIndex;
-		const int32 FirstIndex = MeshSection.BaseIndex;
-
 		// Remember this section
 		FTiXMeshSection TiXSection;
 		TiXSection.NumTriangles = MeshSection.NumTriangles;
-		TiXSection.IndexStart = FirstIndex;
+		TiXSection.IndexStart = MeshSection.BaseIndex;
 		for (int32 b = 0; b < MeshSection.BoneMap.Num(); b++)
 		{
 			TiXSection.BoneMap.Add(MeshSection.BoneMap[b]);
 		}
-		MeshSections.Add(TiXSection);
 
 		// Dump section name and material
-		FString MaterialInstancePathName, MaterialSlotName;
-
 		if (TiXExporterSetting.bIgnoreMaterial)
 		{
-			MaterialInstancePathName = TEXT("DebugMaterialSkinMesh");
-			MaterialSlotName = TEXT("DebugMaterialName");
+			MaterialInstancePathNames.Add(TEXT("DebugMaterialSkinMesh"));
+			MaterialSlotNames.Add(TEXT("DebugMaterialName"));
 		}
 		else
 		{
-			MaterialInstancePathName = GetResourcePath(SkeletalMesh->Materials[MeshSection.MaterialIndex].MaterialInterface);
-			MaterialInstancePathName += SkeletalMesh->Materials[MeshSection.MaterialIndex].MaterialInterface->GetName();
-			MaterialSlotName = SkeletalMesh->Materials[MeshSection.MaterialIndex].MaterialSlotName.ToString();
-			ExportMaterialInstance(SkeletalMesh->Materials[MeshSection.MaterialIndex].MaterialInterface, InExportPath);
+			const int32 MaterialIndex = GetSkeletalSectionMaterialIndex(SkeletalMesh, RenderLODIndex, Section);
+			UMaterialInterface* MaterialInterface = GetExportedMaterial(SkeletalMesh->Materials[MaterialIndex].MaterialInterface);
+			TiXSection.bDepthWrite = MaterialInterface == nullptr || IsDepthWriteBlendMode(MaterialInterface->GetBlendMode());
+			MaterialInstancePathNames.Add(GetResourcePathName(MaterialInterface));
+			MaterialSlotNames.Add(SkeletalMesh->Materials[MaterialIndex].MaterialSlotName.ToString());
+			ExportMaterialInstance(MaterialInterface, InExportPath);
 		}
+		MeshSections.Add(TiXSection);
+	}
 
-		// Collect vertices and indices
-		const int32 MaxIndex = FirstIndex + TotalFaces * 3;
-		for (int32 ii = FirstIndex; ii < MaxIndex; ++ii)
+	// data container
+	FTiXVertexStreams VertexData;
+	TArray<uint32> IndexData;
+	if (GeneratedLOD != nullptr)
+	{
+		VertexData = GeneratedLOD->Vertices;
+		IndexData = GeneratedLOD->Indices;
+		for (int32 Section = 0; Section < MeshSections.Num(); ++Section)
 		{
-			uint32 Index = MeshIndices[ii];
-			check(Index < (uint32)VertexData.Num());
-
-			FTiXVertex Vertex;
-			Vertex.Position = PositionVertexBuffer.VertexPosition(Index) * TiXExporterSetting.MeshVertexPositionScale;
-			if ((VsFormat & EVSSEG_NORMAL) != 0)
-			{
-				Vertex.Normal = StaticMeshVertexBuffer.VertexTangentZ(Index).GetSafeNormal();
-			}
-			if ((VsFormat & EVSSEG_TANGENT) != 0)
-			{
-				Vertex.TangentX = StaticMeshVertexBuffer.VertexTangentX(Index).GetSafeNormal();
-			}
-			if ((VsFormat & EVSSEG_TEXCOORD0) != 0)
-			{
-				Vertex.TexCoords[0] = StaticMeshVertexBuffer.GetVertexUV(Index, 0);
-			}
-			if ((VsFormat & EVSSEG_TEXCOORD1) != 0)
-			{
-				Vertex.TexCoords[1] = StaticMeshVertexBuffer.GetVertexUV(Index, 1);
-			}
-			if ((VsFormat & EVSSEG_COLOR) != 0)
-			{
-				FColor C = ColorVertexBuffer.VertexColor(Index);
-				const float OneOver255 = 1.f / 255.f;
-				Vertex.Color.X = C.R * OneOver255;
-				Vertex.Color.Y = C.G * OneOver255;
-				Vertex.Color.Z = C.B * OneOver255;
-				Vertex.Color.W = C.A * OneOver255;
-			}
-			if ((VsFormat & EVSSEG_BLENDINDEX) != 0)
-			{
-				FSkinWeightInfo Info = SkinWeightVertexBuffer.GetVertexSkinWeights(Index);
-				Vertex.BlendIndex[0] = Info.InfluenceBones[0];
-				Vertex.BlendIndex[1] = Info.InfluenceBones[1];
-				Vertex.BlendIndex[2] = Info.InfluenceBones[2];
-				Vertex.BlendIndex[3] = Info.InfluenceBones[3];
-				Vertex.BlendWeight[0] = Info.InfluenceWeights[0] / 255.f;
-				Vertex.BlendWeight[1] = Info.InfluenceWeights[1] / 255.f;
-				Vertex.BlendWeight[2] = Info.InfluenceWeights[2] / 255.f;
-				Vertex.BlendWeight[3] = Info.InfluenceWeights[3] / 255.f;
-			}
-
-			VertexData[Index] = Vertex;
+			MeshSections[Section].IndexStart = GeneratedLOD->Sections[Section].IndexStart;
+			MeshSections[Section].NumTriangles = GeneratedLOD->Sections[Section].NumTriangles;
 		}
+	}
+	else
+	{
+		GatherRenderVertices(RenderVertexBuffers, VsFormat, MeshIndices, MeshSections, VertexData, IndexData);
+	}
 
-		TSharedPtr<FJsonObject> JSection = SaveMeshSectionToJson(TiXSection, MaterialSlotName, MaterialInstancePathName + ExtName);
+	// Finish indices, sections are saved with their final ranges
+	RemoveDegenerateTriangles(SkeletalMesh, LODIndex, MeshSections, VertexData.Positions, IndexData);
+	OptimizeSectionIndices(SkeletalMesh, MeshSections, VertexData.Positions, IndexData);
+	if (TiXExporterSetting.bEnableVertexFetchOptimization)
+	{
+		FTiXMeshOptimizer::OptimizeVertexFetch(IndexData, VertexData);
+	}
+	CalcSectionVertexRanges(MeshSections, IndexData);
+	RebaseSectionIndices(MeshSections, IndexData, VertexData.Num());
 
-		// Disable mesh cluster generate in UE4. Make this happen in converter.
-		if (false && TiXExporterSetting.bEnableMeshCluster)
-		{
-			//UE_LOG(LogTiXExporter, Log, TEXT("Generate clusters for [%s]."), *StaticMesh->GetName());
-			//TArray< TSharedPtr<FJsonValue> > JClusters;
-			//GenerateMeshCluster(VertexData, IndexData, JClusters);
-			//JSection->SetArrayField("clusters", JClusters);
-		}
+	TArray< TSharedPtr<FJsonValue> > JsonSections;
+	for (int32 Section = 0; Section < MeshSections.Num(); ++Section)
+	{
+		TSharedPtr<FJsonObject> JSection = SaveMeshSectionToJson(MeshSections[Section], MaterialSlotNames[Section], MaterialInstancePathNames[Section] + ExtName);
 
 		TSharedRef< FJsonValueObject > JsonSectionValue = MakeShareable(new FJsonValueObject(JSection));
 		JsonSections.Add(JsonSectionValue);
 	}
 
 	// Export mesh data
-	TSharedPtr<FJsonObject> JMeshData = SaveMeshDataToJson(VertexData, IndexData, VsFormat);
+	TSharedPtr<FJsonObject> JMeshData = SaveMeshDataToJson(VertexData, IndexData);
+
+	// output lod
+	const FSkeletalMeshLODInfo* LODInfo = SkeletalMesh->GetLODInfo(RenderLODIndex);
+	TSharedPtr<FJsonObject> JLOD = MakeShareable(new FJsonObject);
+	JLOD->SetNumberField(TEXT("lod"), LODIndex);
+	JLOD->SetNumberField(TEXT("screen_size"), GeneratedLOD != nullptr ? GeneratedLOD->ScreenSize : (LODInfo != nullptr ? LODInfo->ScreenSize.Default : 0.f));
+	JLOD->SetNumberField(TEXT("vertex_count_total"), VertexData.Num());
+	JLOD->SetNumberField(TEXT("index_count_total"), IndexData.Num());
+	JLOD->SetNumberField(TEXT("texcoord_count"), TotalNumTexCoords);
+	JLOD->SetObjectField(TEXT("data"), JMeshData);
+	JLOD->SetArrayField(TEXT("sections"), JsonSections);
+	return JLOD;
+}
+
+void UTiXExporterBPLibrary::ExportSkeletalMeshFromRenderData(USkeletalMesh* SkeletalMesh, FString InExportPath, const TArray<FString>& Components)
+{
+	FTiXScopedAssetExport ScopedExport(SkeletalMesh);
+	if (!ScopedExport.ShouldExport())
+	{
+		return;
+	}
+
+	const FString ExportFullPath = GetResourceExportPath(SkeletalMesh, InExportPath);
+
+	// Generated LODs are coarser than all render LODs
+	TArray<FTiXGeneratedLOD> LocalLODs;
+	const TArray<FTiXGeneratedLOD>& GeneratedLODs = GetGeneratedMeshLODs(SkeletalMesh, Components, LocalLODs);
+	FSkeletalMeshRenderData* SKMRenderData = SkeletalMesh->GetResourceForRendering();
+	const int32 RenderLODs = SKMRenderData->LODRenderData.Num();
+	const int32 TotalLODs = RenderLODs + GeneratedLODs.Num();
+	const int32 TotalNumTexCoords = SKMRenderData->LODRenderData[0].StaticVertexBuffers.StaticMeshVertexBuffer.GetNumTexCoords();
+
+	USkeleton* Skeleton = SkeletalMesh->Skeleton;
+	FString SkeletonPath = GetResourcePathName(Skeleton) + TEXT(".tasset");
+	ExportSkeleton(Skeleton, InExportPath);
+
+	// Coarse LODs go first, so they can be loaded before finer ones
+	TArray< TSharedPtr<FJsonValue> > JLODs;
+	int32 TotalVertices = 0, TotalIndices = 0;
+	for (int32 LODIndex = TotalLODs - 1; LODIndex >= 0; --LODIndex)
+	{
+		const FTiXGeneratedLOD* GeneratedLOD = LODIndex >= RenderLODs ? &GeneratedLODs[LODIndex - RenderLODs] : nullptr;
+		TSharedPtr<FJsonObject> JLOD = ExportSkeletalMeshLOD(SkeletalMesh, LODIndex, GeneratedLOD, InExportPath, Components);
+		if (!JLOD.IsValid())
+		{
+			return;
+		}
+		TotalVertices += JLOD->GetIntegerField(TEXT("vertex_count_total"));
+		TotalIndices += JLOD->GetIntegerField(TEXT("index_count_total"));
+		JLODs.Add(MakeShareable(new FJsonValueObject(JLOD)));
+	}
 
 	// Export collision infos
 	//TSharedPtr<FJsonObject> JCollisions = ExportMeshCollisions(StaticMesh);
@@ -1033,35 +2154,34 @@ void UTiXExporterBPLibrary::ExportSkeletalMeshFromRenderData(USkeletalMesh* Skel
 		JsonObject->SetStringField(TEXT("type"), TEXT("skeletal_mesh"));
 		JsonObject->SetNumberField(TEXT("version"), 1);
 		JsonObject->SetStringField(TEXT("desc"), TEXT("Skeletal mesh (Render Resource) from TiX exporter."));
-		JsonObject->SetNumberField(TEXT("vertex_count_total"), VertexData.Num());
-		//LODResource.VertexBuffers.PositionVertexBuffer.GetNumVertices());
-		JsonObject->SetNumberField(TEXT("index_count_total"), IndexData.Num());
-		//MeshIndices.Num());
+		JsonObject->SetNumberField(TEXT("vertex_count_total"), TotalVertices);
+		JsonObject->SetNumberField(TEXT("index_count_total"), TotalIndices);
 		JsonObject->SetNumberField(TEXT("texcoord_count"), TotalNumTexCoords);
-		JsonObject->SetNumberField(TEXT("total_lod"), 1);
+		JsonObject->SetNumberField(TEXT("total_lod"), TotalLODs);
 		JsonObject->SetStringField(TEXT("skeleton"), SkeletonPath);
 
-		// output mesh data
-		JsonObject->SetObjectField(TEXT("data"), JMeshData);
-
-		// output mesh sections
-		JsonObject->SetArrayField(TEXT("sections"), JsonSections);
+		// output mesh data and sections of each lod
+		JsonObject->SetArrayField(TEXT("lods"), JLODs);
 
 		// output mesh collisions
 		//JsonObject->SetObjectField(TEXT("collisions"), JCollisions);
 
-		SaveJsonToFile(JsonObject, SkeletalMesh->GetName(), ExportFullPath);
+		if (SaveJsonToFile(JsonObject, SkeletalMesh->GetName(), ExportFullPath))
+		{
+			ScopedExport.MarkSucceeded();
+		}
 	}
 }
 
 void UTiXExporterBPLibrary::ExportSkeleton(USkeleton* InSkeleton, const FString& InExportPath)
 {
-	FString Path = GetResourcePath(InSkeleton);
-	FString ExportPath = InExportPath;
-	ExportPath.ReplaceInline(TEXT("\\"), TEXT("/"));
-	if (ExportPath[ExportPath.Len() - 1] != '/')
-		ExportPath.AppendChar('/');
-	FString ExportFullPath = ExportPath + Path;
+	FTiXScopedAssetExport ScopedExport(InSkeleton);
+	if (!ScopedExport.ShouldExport())
+	{
+		return;
+	}
+
+	const FString ExportFullPath = GetResourceExportPath(InSkeleton, InExportPath);
 
 	// Skeleton infos
 	const FReferenceSkeleton& RefSkeleton = InSkeleton->GetReferenceSkeleton();
@@ -1108,20 +2228,24 @@ void UTiXExporterBPLibrary::ExportSkeleton(USkeleton* InSkeleton, const FString&
 
 	FString JsonStr;
 	FJsonObjectConverter::UStructToJsonObjectString(SkeletonAsset, JsonStr);
-	SaveJsonToFile(JsonStr, InSkeleton->GetName(), *ExportFullPath);
+	if (SaveJsonToFile(JsonStr, InSkeleton->GetName(), *ExportFullPath))
+	{
+		ScopedExport.MarkSucceeded();
+	}
 }
 
 void UTiXExporterBPLibrary::ExportAnimationAsset(UAnimationAsset* InAnimAsset, FString InExportPath)
 {
-	FString Path = GetResourcePath(InAnimAsset);
-	FString ExportPath = InExportPath;
-	ExportPath.ReplaceInline(TEXT("\\"), TEXT("/"));
-	if (ExportPath[ExportPath.Len() - 1] != '/')
-		ExportPath.AppendChar('/');
-	FString ExportFullPath = ExportPath + Path;
+	FTiXScopedAssetExport ScopedExport(InAnimAsset);
+	if (!ScopedExport.ShouldExport())
+	{
+		return;
+	}
+
+	const FString ExportFullPath = GetResourceExportPath(InAnimAsset, InExportPath);
 
 	USkeleton* Skeleton = InAnimAsset->GetSkeleton();
-	FString SkeletonPath = GetResourcePath(Skeleton) + Skeleton->GetName() + TEXT(".tasset");
+	FString SkeletonPath = GetResourcePathName(Skeleton) + TEXT(".tasset");
 	const FReferenceSkeleton& RefSkeleton = Skeleton->GetReferenceSkeleton();
 	const TArray<FMeshBoneInfo>& BoneInfos = RefSkeleton.GetRawRefBoneInfo();
 
@@ -1187,7 +2311,10 @@ void UTiXExporterBPLibrary::ExportAnimationAsset(UAnimationAsset* InAnimAsset, F
 
 	FString JsonStr;
 	FJsonObjectConverter::UStructToJsonObjectString(AnimAsset, JsonStr);
-	SaveJsonToFile(JsonStr, InAnimAsset->GetName(), *ExportFullPath);
+	if (SaveJsonToFile(JsonStr, InAnimAsset->GetName(), *ExportFullPath))
+	{
+		ScopedExport.MarkSucceeded();
+	}
 }
 
 TSharedPtr<FJsonObject> UTiXExporterBPLibrary::ExportMeshCollisions(const UStaticMesh * InMesh)
@@ -1337,9 +2464,9 @@ void UTiXExporterBPLibrary::ExportStaticMeshFromRawMesh(UStaticMesh* StaticMesh,
 		Model.LoadRawMesh(ReadMesh);
 		const FRawMesh& MeshData = ReadMesh;
 
-		TArray<TArray<FTiXVertex>> Vertices;
+		TArray<FTiXVertexStreams> Vertices;
 		TArray<TArray<int32>> Indices;
-		TArray<TMap<FTiXVertex, int32>> IndexMap;
+		TIndirectArray<FTiXVertexWelder> Welders;
 		TArray<FStaticMaterial*> Materials;
 
 		check(MeshData.FaceMaterialIndices.Num() * 3 == MeshData.WedgeIndices.Num());
@@ -1371,7 +2498,6 @@ void UTiXExporterBPLibrary::ExportStaticMeshFromRawMesh(UStaticMesh* StaticMesh,
 		// Init array
 		Vertices.AddZeroed(MaterialSections.Num());
 		Indices.AddZeroed(MaterialSections.Num());
-		IndexMap.AddZeroed(MaterialSections.Num());
 		Materials.AddZeroed(MaterialSections.Num());
 
 		int32 TexCoordCount = 0;
@@ -1385,35 +2511,66 @@ void UTiXExporterBPLibrary::ExportStaticMeshFromRawMesh(UStaticMesh* StaticMesh,
 		}
 
 		// Get Vertex format
-		uint32 VsFormat = 0;
-		if (MeshData.VertexPositions.Num() > 0 && ContainComponent(Components, (TEXT("POSITION"))))
-		{
-			VsFormat |= EVSSEG_POSITION;
-		}
-		else
+		const uint32 RequestedVsFormat = GetRequestedVsFormat(Components);
+		if (MeshData.VertexPositions.Num() == 0 || (RequestedVsFormat & EVSSEG_POSITION) == 0)
 		{
 			UE_LOG(LogTiXExporter, Error, TEXT("Static mesh [%s] do not have position stream."), *StaticMesh->GetPathName());
 			return;
 		}
-		if (MeshData.WedgeTangentZ.Num() > 0 && ContainComponent(Components, (TEXT("NORMAL"))))
+		uint32 VsFormat = EVSSEG_POSITION;
+		if (MeshData.WedgeTangentZ.Num() > 0)
+		{
+			VsFormat |= RequestedVsFormat & EVSSEG_NORMAL;
+		}
+		if (MeshData.WedgeColors.Num() > 0)
+		{
+			VsFormat |= RequestedVsFormat & EVSSEG_COLOR;
+		}
+		if (MeshData.WedgeTexCoords[0].Num() > 0)
+		{
+			VsFormat |= RequestedVsFormat & EVSSEG_TEXCOORD0;
+		}
+		if (MeshData.WedgeTexCoords[1].Num() > 0)
+		{
+			VsFormat |= RequestedVsFormat & EVSSEG_TEXCOORD1;
+		}
+		if (MeshData.WedgeTangentX.Num() > 0)
+		{
+			VsFormat |= RequestedVsFormat & EVSSEG_TANGENT;
+		}
+
+		// Wedge streams, copied as a whole
+		const int32 NumWedges = MeshData.WedgeIndices.Num();
+		FTiXVertexStreams Wedges(VsFormat);
+		Wedges.Positions.SetNumUninitialized(NumWedges);
+		for (int32 w = 0; w < NumWedges; ++w)
+		{
+			Wedges.Positions[w] = MeshData.VertexPositions[MeshData.WedgeIndices[w]] * TiXExporterSetting.MeshVertexPositionScale;
+		}
+		if ((VsFormat & EVSSEG_NORMAL) != 0)
 		{
-			VsFormat |= EVSSEG_NORMAL;
+			Wedges.Normals = MeshData.WedgeTangentZ;
 		}
-		if (MeshData.WedgeColors.Num() > 0 && ContainComponent(Components, (TEXT("COLOR"))))
+		if ((VsFormat & EVSSEG_COLOR) != 0)
 		{
-			VsFormat |= EVSSEG_COLOR;
+			Wedges.Colors = MeshData.WedgeColors;
 		}
-		if (MeshData.WedgeTexCoords[0].Num() > 0 && ContainComponent(Components, (TEXT("TEXCOORD0"))))
+		for (int32 uv = 0; uv < MAX_TIX_TEXTURE_COORDS; ++uv)
 		{
-			VsFormat |= EVSSEG_TEXCOORD0;
+			if ((VsFormat & (uv == 0 ? EVSSEG_TEXCOORD0 : EVSSEG_TEXCOORD1)) != 0)
+			{
+				Wedges.TexCoords[uv] = MeshData.WedgeTexCoords[uv];
+			}
 		}
-		if (MeshData.WedgeTexCoords[1].Num() > 0 && ContainComponent(Components, (TEXT("TEXCOORD1"))))
+		if ((VsFormat & EVSSEG_TANGENT) != 0)
 		{
-			VsFormat |= EVSSEG_TEXCOORD1;
+			Wedges.Tangents = MeshData.WedgeTangentX;
 		}
-		if (MeshData.WedgeTangentX.Num() > 0 && ContainComponent(Components, (TEXT("TANGENT"))))
+
+		// Wedges are welded per section, MaterialSections counts faces from 0
+		for (int32 section = 0; section < MaterialSections.Num(); ++section)
 		{
-			VsFormat |= EVSSEG_TANGENT;
+			Welders.Add(new FTiXVertexWelder(VsFormat, (MaterialSections[section] + 1) * 3, TiXExporterSetting.VertexWeldEpsilon));
 		}
 
 		// Add data for each section
@@ -1422,50 +2579,20 @@ void UTiXExporterBPLibrary::ExportStaticMeshFromRawMesh(UStaticMesh* StaticMesh,
 			int32 FaceMaterialIndex = MeshData.FaceMaterialIndices[face];
 			int32 IndexOffset = face * 3;
 
-			TArray<FTiXVertex>& VertexSection = Vertices[FaceMaterialIndex];
 			TArray<int32>& IndexSection = Indices[FaceMaterialIndex];
-			TMap<FTiXVertex, int32>& IndexMapSection = IndexMap[FaceMaterialIndex];
+			FTiXVertexWelder& WelderSection = Welders[FaceMaterialIndex];
 
 			for (int32 i = 0; i < 3; ++i)
 			{
-				FTiXVertex Vertex;
-				Vertex.Position = MeshData.VertexPositions[MeshData.WedgeIndices[IndexOffset + i]] * TiXExporterSetting.MeshVertexPositionScale;
-				Vertex.Normal = MeshData.WedgeTangentZ[IndexOffset + i];
-				if (MeshData.WedgeColors.Num() > 0)
-				{
-					const float OneOver255 = 1.f / 255.f;
-					FColor C = MeshData.WedgeColors[IndexOffset + i];
-					Vertex.Color.X = C.R * OneOver255;
-					Vertex.Color.Y = C.G * OneOver255;
-					Vertex.Color.Z = C.B * OneOver255;
-					Vertex.Color.W = C.A * OneOver255;
-				}
-				if (MeshData.WedgeTangentX.Num() > 0)
-				{
-					Vertex.TangentX = MeshData.WedgeTangentX[IndexOffset + i];
-				}
-				for (int32 uv = 0; uv < TexCoordCount; ++uv)
-				{
-					Vertex.TexCoords[uv] = MeshData.WedgeTexCoords[uv][IndexOffset + i];
-				}
-
 				// gather vertices and indices
-				int32 * VertexIndex = IndexMapSection.Find(Vertex);
-				if (VertexIndex == nullptr)
-				{
-					// Add a new vertex to vertex buffer
-					VertexSection.Add(Vertex);
-					int32 CurrentIndex = VertexSection.Num() - 1;
-					IndexSection.Add(CurrentIndex);
-					IndexMapSection.Add(Vertex, CurrentIndex);
-				}
-				else
-				{
-					// Add an exist vertex's index
-					IndexSection.Add(*VertexIndex);
-				}
+				IndexSection.Add(WelderSection.AddVertex(Wedges, IndexOffset + i));
 			}
 		}
+		for (int32 section = 0; section < MaterialSections.Num(); ++section)
+		{
+			Vertices[section] = MoveTemp(Welders[section].GetVertices());
+		}
+		Welders.Empty();
 
 		// Get Material info
 		for (int32 section = 0; section < MaterialSections.Num(); ++section)
@@ -1508,6 +2635,7 @@ void UTiXExporterBPLibrary::ExportStaticMeshFromRawMesh(UStaticMesh* StaticMesh,
 
 void UTiXExporterBPLibrary::ExportMaterialInstance(UMaterialInterface* InMaterial, const FString& InExportPath)
 {
+	InMaterial = GetExportedMaterial(InMaterial);
 	if (InMaterial->IsA(UMaterial::StaticClass()))
 	{
 		ExportMaterial(InMaterial, InExportPath);
@@ -1517,28 +2645,31 @@ void UTiXExporterBPLibrary::ExportMaterialInstance(UMaterialInterface* InMateria
 		check(InMaterial->IsA(UMaterialInstance::StaticClass()));
 		UMaterialInstance * MaterialInstance = Cast<UMaterialInstance>(InMaterial);
 
-		FString Path = GetResourcePath(MaterialInstance);
-		FString ExportPath = InExportPath;
-		ExportPath.ReplaceInline(TEXT("\\"), TEXT("/"));
-		if (ExportPath[ExportPath.Len() - 1] != '/')
-			ExportPath.AppendChar('/');
-		FString ExportFullPath = ExportPath + Path;
+		// Instance chains are flattened, linked to the root material with resolved parameters
+		FTiXFlattenedMaterialInstance Flattened;
+		FlattenMaterialInstance(MaterialInstance, Flattened);
 
-		// Linked Material
-		UMaterialInterface * ParentMaterial = MaterialInstance->Parent;
-		check(ParentMaterial && ParentMaterial->IsA(UMaterial::StaticClass()));
+		// Linked Material, before the cache check, scene refers to its pipeline state for up to date instances too
+		UMaterialInterface * ParentMaterial = Flattened.RootMaterial;
 		ExportMaterial(ParentMaterial, InExportPath);
-		FString MaterialPathName = GetResourcePath(ParentMaterial);
-		MaterialPathName += ParentMaterial->GetName();
+
+		FTiXScopedAssetExport ScopedExport(MaterialInstance);
+		if (!ScopedExport.ShouldExport())
+		{
+			return;
+		}
+
+		const FString ExportFullPath = GetResourceExportPath(MaterialInstance, InExportPath);
+		FString MaterialPathName = GetResourcePathName(ParentMaterial);
 
 		// Parameters
 		// Scalar parameters
 		TArray<FVector4> ScalarVectorParams;
 		TArray<FString> ScalarVectorNames;
 		TArray<FString> ScalarVectorComments;
-		for (int32 i = 0; i < MaterialInstance->ScalarParameterValues.Num(); ++i)
+		for (int32 i = 0; i < Flattened.ScalarParameters.Num(); ++i)
 		{
-			const FScalarParameterValue& ScalarValue = MaterialInstance->ScalarParameterValues[i];
+			const FScalarParameterValue& ScalarValue = Flattened.ScalarParameters[i];
 
 			int32 CombinedIndex = i / 4;
 			int32 IndexInVector4 = i % 4;
@@ -1557,9 +2688,9 @@ void UTiXExporterBPLibrary::ExportMaterialInstance(UMaterialInterface* InMateria
 		}
 
 		// Vector parameters.
-		for (int32 i = 0; i < MaterialInstance->VectorParameterValues.Num(); ++i)
+		for (int32 i = 0; i < Flattened.VectorParameters.Num(); ++i)
 		{
-			const FVectorParameterValue& VectorValue = MaterialInstance->VectorParameterValues[i];
+			const FVectorParameterValue& VectorValue = Flattened.VectorParameters[i];
 
 			ScalarVectorParams.Add(FVector4(VectorValue.ParameterValue));
 			ScalarVectorNames.Add(VectorValue.ParameterInfo.Name.ToString());
@@ -1570,17 +2701,25 @@ void UTiXExporterBPLibrary::ExportMaterialInstance(UMaterialInterface* InMateria
 		TArray<FString> TextureParams;
 		TArray<FString> TextureParamNames;
 		TArray<UTexture*> Textures;
-		for (int32 i = 0; i < MaterialInstance->TextureParameterValues.Num(); ++i)
+		TArray<int32> TextureMipBiases;
+		for (int32 i = 0; i < Flattened.TextureParameters.Num(); ++i)
 		{
-			const FTextureParameterValue& TextureValue = MaterialInstance->TextureParameterValues[i];
+			const FTextureParameterValue& TextureValue = Flattened.TextureParameters[i];
 
-			FString TexturePath = GetResourcePath(TextureValue.ParameterValue);
-			TexturePath += TextureValue.ParameterValue->GetName();
+			// Duplicated textures reference the shared copy
+			UTexture* ExportedTexture = TextureValue.ParameterValue;
+			const FTiXTextureDuplicate* Duplicate = FTiXExportSession::Get().FindTextureDuplicate(ExportedTexture);
+			if (Duplicate != nullptr)
+			{
+				ExportedTexture = Duplicate->Representative;
+			}
+			FString TexturePath = GetResourcePathName(ExportedTexture);
 			TextureParams.Add(TexturePath);
 			TextureParamNames.Add(TextureValue.ParameterInfo.Name.ToString());
 			Textures.Add(TextureValue.ParameterValue);
+			TextureMipBiases.Add(Duplicate != nullptr ? Duplicate->MipBias : 0);
 
-			ExportTexture(TextureValue.ParameterValue, InExportPath);
+			ExportTexture(ExportedTexture, InExportPath);
 		}
 
 		// output json
@@ -1649,30 +2788,32 @@ void UTiXExporterBPLibrary::ExportMaterialInstance(UMaterialInterface* InMateria
 				TArray< TSharedPtr<FJsonValue> > JResolution;
 				ConvertToJsonArray(Resolution, JResolution);
 				JParameter->SetArrayField(TEXT("size"), JResolution);
+				if (TextureMipBiases[TexParam] > 0)
+				{
+					// Shared texture is larger, sample from this mip
+					JParameter->SetNumberField(TEXT("mip_bias"), TextureMipBiases[TexParam]);
+				}
 
 				JParameters->SetObjectField(TextureParamNames[TexParam], JParameter);
 			}
 			JsonObject->SetObjectField(TEXT("parameters"), JParameters);
-			SaveJsonToFile(JsonObject, InMaterial->GetName(), ExportFullPath);
+			if (SaveJsonToFile(JsonObject, InMaterial->GetName(), ExportFullPath))
+			{
+				ScopedExport.MarkSucceeded();
+			}
 		}
 	}
 }
 
-void UTiXExporterBPLibrary::ExportMaterial(UMaterialInterface* InMaterial, const FString& InExportPath)
+/**
+* Render states of a material, everything the runtime needs to create its pipeline.
+* Fields are always written in the same order, so equal states serialize to equal strings.
+*/
+static TSharedPtr<FJsonObject> GetMaterialPipelineState(const UMaterial* Material)
 {
-	check(InMaterial->IsA(UMaterial::StaticClass()));
-	UMaterial * Material = Cast<UMaterial>(InMaterial);
-
-	FString Path = GetResourcePath(Material);
-	FString ExportPath = InExportPath;
-	ExportPath.ReplaceInline(TEXT("\\"), TEXT("/"));
-	if (ExportPath[ExportPath.Len() - 1] != '/')
-		ExportPath.AppendChar('/');
-	FString ExportFullPath = ExportPath + Path;
-
 	// Material infos
 	const FString ShaderPrefix = TEXT("S_");
-	FString ShaderName = InMaterial->GetName();
+	FString ShaderName = Material->GetName();
 	if (ShaderName.Left(2) == TEXT("M_"))
 		ShaderName = ShaderName.Right(ShaderName.Len() - 2);
 	ShaderName = ShaderPrefix + ShaderName;
@@ -1722,10 +2863,57 @@ void UTiXExporterBPLibrary::ExportMaterial(UMaterialInterface* InMaterial, const
 		BlendMode = TEXT("BLEND_MODE_TRANSLUCENTs");
 		break;
 	}
-	bool bDepthWrite = Material->BlendMode == BLEND_Opaque || Material->BlendMode == BLEND_Masked;
+	bool bDepthWrite = IsDepthWriteBlendMode(Material->BlendMode);
 	bool bDepthTest = true;
 	bool bTwoSides = Material->IsTwoSided();
 
+	TSharedPtr<FJsonObject> JsonObject = MakeShareable(new FJsonObject);
+	TArray< TSharedPtr<FJsonValue> > JShaders, JVSFormats, JInsFormats, JRTColors;
+	ConvertToJsonArray(Shaders, JShaders);
+	ConvertToJsonArray(VSFormats, JVSFormats);
+	ConvertToJsonArray(InsFormats, JInsFormats);
+	ConvertToJsonArray(RTColors, JRTColors);
+	JsonObject->SetArrayField(TEXT("shaders"), JShaders);
+	JsonObject->SetArrayField(TEXT("vs_format"), JVSFormats);
+	JsonObject->SetArrayField(TEXT("ins_format"), JInsFormats);
+	JsonObject->SetArrayField(TEXT("rt_colors"), JRTColors);
+
+	JsonObject->SetStringField(TEXT("rt_depth"), RTDepth);
+	JsonObject->SetStringField(TEXT("blend_mode"), BlendMode);
+	JsonObject->SetBoolField(TEXT("depth_write"), bDepthWrite);
+	JsonObject->SetBoolField(TEXT("depth_test"), bDepthTest);
+	JsonObject->SetBoolField(TEXT("two_sides"), bTwoSides);
+	return JsonObject;
+}
+
+/** Name of a pipeline state, hashed from its canonical string. */
+static FString GetPipelineStateName(TSharedPtr<FJsonObject> PipelineState)
+{
+	FString Canonical;
+	TSharedRef< TJsonWriter<TCHAR, TCondensedJsonPrintPolicy<TCHAR> > > Writer = TJsonWriterFactory<TCHAR, TCondensedJsonPrintPolicy<TCHAR>>::Create(&Canonical);
+	FJsonSerializer::Serialize(PipelineState.ToSharedRef(), Writer);
+	const uint64 Hash = CityHash64((const char*)*Canonical, Canonical.Len() * sizeof(TCHAR));
+	return FString::Printf(TEXT("pso_%016llx"), Hash);
+}
+
+void UTiXExporterBPLibrary::ExportMaterial(UMaterialInterface* InMaterial, const FString& InExportPath)
+{
+	check(InMaterial->IsA(UMaterial::StaticClass()));
+	UMaterial * Material = Cast<UMaterial>(InMaterial);
+
+	// Register pipeline state before the cache check, scene refers to states of up to date materials too
+	TSharedPtr<FJsonObject> PipelineState = GetMaterialPipelineState(Material);
+	const FString PipelineStateName = GetPipelineStateName(PipelineState);
+	FTiXExportSession::Get().AddPipelineState(PipelineStateName, PipelineState);
+
+	FTiXScopedAssetExport ScopedExport(Material);
+	if (!ScopedExport.ShouldExport())
+	{
+		return;
+	}
+
+	const FString ExportFullPath = GetResourceExportPath(Material, InExportPath);
+
 	// output json
 	{
 		TSharedPtr<FJsonObject> JsonObject = MakeShareable(new FJsonObject);
@@ -1736,23 +2924,16 @@ void UTiXExporterBPLibrary::ExportMaterial(UMaterialInterface* InMaterial, const
 		JsonObject->SetNumberField(TEXT("version"), 1);
 		JsonObject->SetStringField(TEXT("desc"), TEXT("Material from TiX exporter."));
 
-		// material info
-		TArray< TSharedPtr<FJsonValue> > JShaders, JVSFormats, JInsFormats, JRTColors;
-		ConvertToJsonArray(Shaders, JShaders);
-		ConvertToJsonArray(VSFormats, JVSFormats);
-		ConvertToJsonArray(InsFormats, JInsFormats);
-		ConvertToJsonArray(RTColors, JRTColors);
-		JsonObject->SetArrayField(TEXT("shaders"), JShaders);
-		JsonObject->SetArrayField(TEXT("vs_format"), JVSFormats);
-		JsonObject->SetArrayField(TEXT("ins_format"), JInsFormats);
-		JsonObject->SetArrayField(TEXT("rt_colors"), JRTColors);
-
-		JsonObject->SetStringField(TEXT("rt_depth"), RTDepth);
-		JsonObject->SetStringField(TEXT("blend_mode"), BlendMode);
-		JsonObject->SetBoolField(TEXT("depth_write"), bDepthWrite);
-		JsonObject->SetBoolField(TEXT("depth_test"), bDepthTest);
-		JsonObject->SetBoolField(TEXT("two_sides"), bTwoSides);
-		SaveJsonToFile(JsonObject, InMaterial->GetName(), ExportFullPath);
+		// material info, also inline for materials exported without a scene
+		JsonObject->SetStringField(TEXT("pipeline_state"), PipelineStateName);
+		for (const auto& Field : PipelineState->Values)
+		{
+			JsonObject->SetField(Field.Key, Field.Value);
+		}
+		if (SaveJsonToFile(JsonObject, InMaterial->GetName(), ExportFullPath))
+		{
+			ScopedExport.MarkSucceeded();
+		}
 	}
 }
 
@@ -1763,24 +2944,30 @@ void UTiXExporterBPLibrary::ExportTexture(UTexture* InTexture, const FString& In
 		UE_LOG(LogTiXExporter, Error, TEXT("  Texture other than UTexture2D and UTextureCube are NOT supported yet."));
 		return;
 	}
+	if (FTiXExportSession::Get().FindTextureDuplicate(InTexture) != nullptr)
+	{
+		// Exported as its representative
+		return;
+	}
+	FTiXScopedAssetExport ScopedExport(InTexture);
+	if (!ScopedExport.ShouldExport())
+	{
+		return;
+	}
+
 	const bool IsTexture2D = InTexture->IsA(UTexture2D::StaticClass());
 	UTexture2D* InTexture2D = Cast<UTexture2D>(InTexture);
 	UTextureCube* InTextureCube = Cast<UTextureCube>(InTexture);
 
-	FString Path = GetResourcePath(InTexture);
-	FString ExportPath = InExportPath;
-	ExportPath.ReplaceInline(TEXT("\\"), TEXT("/"));
-	if (ExportPath[ExportPath.Len() - 1] != '/')
-		ExportPath.AppendChar('/');
 	FString ExportFullPath;
 	if (!UsedAsIBL)
-		ExportFullPath = ExportPath + Path;
+		ExportFullPath = GetResourceExportPath(InTexture, InExportPath);
 	else
-		ExportFullPath = ExportPath;
+		ExportFullPath = NormalizeExportPath(InExportPath);
 
 	// Save texture 2d with tga format and texture cube with hdr format
 	FString ImageExtName = IsTexture2D ? TEXT("tga") : TEXT("hdr");
-	FString FullPathName = Path + InTexture->GetName();
+	const FString FullPathName = GetResourcePathName(InTexture);
 
 	FBufferArchive Buffer;
 	if (IsTexture2D)
@@ -1856,32 +3043,50 @@ void UTiXExporterBPLibrary::ExportTexture(UTexture* InTexture, const FString& In
 
 		int32 LodBias = InTexture->LODBias;
 		JsonObject->SetNumberField(TEXT("lod_bias"), LodBias);
-		SaveJsonToFile(JsonObject, InTexture->GetName(), ExportFullPath);
+		if (SaveJsonToFile(JsonObject, InTexture->GetName(), ExportFullPath))
+		{
+			ScopedExport.MarkSucceeded();
+		}
 	}
 }
 
 void UTiXExporterBPLibrary::ExportReflectionCapture(AReflectionCapture* RCActor, const FString& Path)
 {
 	// Export cubemap data
+	FTiXExportSession& Session = FTiXExportSession::Get();
 	UWorld* CurrentWorld = RCActor->GetWorld();
-	ULevel* CurrentLevel = CurrentWorld->GetCurrentLevel();
 	UReflectionCaptureComponent * RCComponent = RCActor->GetCaptureComponent();
 
-	FReflectionCaptureData ReadbackCaptureData;
-	CurrentWorld->Scene->GetReflectionCaptureData(RCComponent, ReadbackCaptureData);
+	FString TextureName = TEXT("TC_") + RCActor->GetName();
+	FString MapName = CurrentWorld->GetName();
+	FString ExportFullPath = NormalizeExportPath(Path) + MapName + TEXT("/");
+	const FString ExportFullPathName = ExportFullPath + TextureName + TEXT(".tjs");
+	if (Session.IsCaptureFileUpToDate(ExportFullPathName))
+	{
+		// Written from the same captures by a previous export
+		return;
+	}
+
+	// Use the capture data read back for the whole scene if there is one
+	FReflectionCaptureData LocalCaptureData;
+	const FReflectionCaptureData* CachedCaptureData = Session.FindReflectionCaptureData(RCComponent);
+	if (CachedCaptureData == nullptr)
+	{
+		CurrentWorld->Scene->GetReflectionCaptureData(RCComponent, LocalCaptureData);
+	}
+	const FReflectionCaptureData& ReadbackCaptureData = CachedCaptureData != nullptr ? *CachedCaptureData : LocalCaptureData;
 	if (ReadbackCaptureData.CubemapSize > 0)
 	{
-		UMapBuildDataRegistry* Registry = CurrentLevel->GetOrCreateMapBuildData();
 		//if (!RCComponent->bModifyMaxValueRGBM)
 		//{
 		//	RCComponent->MaxValueRGBM = GetMaxValueRGBM(ReadbackCaptureData.FullHDRCapturedData, ReadbackCaptureData.CubemapSize, ReadbackCaptureData.Brightness);
 		//}
-		FString TextureName = TEXT("TC_") + RCActor->GetName();
 		UTextureFactory* TextureFactory = NewObject<UTextureFactory>();
 		TextureFactory->SuppressImportOverwriteDialog();
 
+		// Only used to write the hdr file, keep it out of map build data so the map package is not dirtied
 		TextureFactory->CompressionSettings = TC_HDR;
-		UTextureCube* TextureCube = TextureFactory->CreateTextureCube(Registry, FName(TextureName), RF_Standalone | RF_Public);
+		UTextureCube* TextureCube = TextureFactory->CreateTextureCube(GetTransientPackage(), FName(TextureName), RF_Transient);
 
 		if (TextureCube)
 		{
@@ -1915,15 +3120,12 @@ void UTiXExporterBPLibrary::ExportReflectionCapture(AReflectionCapture* RCActor,
 			TextureCube->MipGenSettings = TMGS_LeaveExistingMips;
 
 			TextureCube->UpdateResource();
-			TextureCube->MarkPackageDirty();
-
-			FString ExportPath = Path;
-			ExportPath.ReplaceInline(TEXT("\\"), TEXT("/"));
-			if (ExportPath[ExportPath.Len() - 1] != '/')
-				ExportPath.AppendChar('/');
-			FString MapName = CurrentWorld->GetName();
-			FString ExportFullPath = ExportPath + MapName + TEXT("/");
+
 			ExportTexture(TextureCube, ExportFullPath, true);
+			if (CachedCaptureData != nullptr && FPaths::FileExists(ExportFullPathName))
+			{
+				Session.MarkCaptureFileExported(ExportFullPathName);
+			}
 		}
 	}
 }
@@ -1937,10 +3139,20 @@ TSharedPtr<FJsonObject> UTiXExporterBPLibrary::ExportStaticMeshInstances(const U
 	// output basic info
 	JsonObject->SetStringField(TEXT("linked_mesh"), MeshPathName + ExtName);
 
-	// only care about LOD 0 for now
-	int32 CurrentLOD = 0;
-	FStaticMeshLODResources& LODResource = InMesh->RenderData->LODResources[CurrentLOD];
-	JsonObject->SetNumberField(TEXT("mesh_sections"), LODResource.Sections.Num());
+	// Section count of each LOD by lod index, generated LODs use sections of LOD0
+	const TArray<FStaticMeshLODResources>& LODResources = InMesh->RenderData->LODResources;
+	const TArray<FTiXGeneratedLOD>* GeneratedLODs = FTiXExportSession::Get().FindGeneratedLODs(InMesh);
+	TArray< TSharedPtr<FJsonValue> > JLODSections;
+	for (const FStaticMeshLODResources& LODResource : LODResources)
+	{
+		JLODSections.Add(MakeShareable(new FJsonValueNumber(LODResource.Sections.Num())));
+	}
+	for (int32 Index = 0; GeneratedLODs != nullptr && Index < GeneratedLODs->Num(); ++Index)
+	{
+		JLODSections.Add(MakeShareable(new FJsonValueNumber(LODResources[0].Sections.Num())));
+	}
+	JsonObject->SetNumberField(TEXT("mesh_sections"), LODResources[0].Sections.Num());
+	JsonObject->SetArrayField(TEXT("lod_sections"), JLODSections);
 
 	TArray< TSharedPtr<FJsonValue> > JMeshInstances;
 	for (const auto& Instance : Instances)
@@ -1974,10 +3186,20 @@ TSharedPtr<FJsonObject> UTiXExporterBPLibrary::ExportSkeletalMeshActors(const US
 	JsonObject->SetStringField(TEXT("linked_skm"), MeshPathName + ExtName);
 	JsonObject->SetStringField(TEXT("linked_sk"), SkeletonPathName + ExtName);
 
-	// only care about LOD 0 for now
-	int32 CurrentLOD = 0;
-	FSkeletalMeshLODRenderData& LODResource = InMesh->GetResourceForRendering()->LODRenderData[CurrentLOD];
-	JsonObject->SetNumberField(TEXT("mesh_sections"), LODResource.RenderSections.Num());
+	// Section count of each LOD by lod index, generated LODs use sections of LOD0
+	const TIndirectArray<FSkeletalMeshLODRenderData>& LODRenderData = InMesh->GetResourceForRendering()->LODRenderData;
+	const TArray<FTiXGeneratedLOD>* GeneratedLODs = FTiXExportSession::Get().FindGeneratedLODs(InMesh);
+	TArray< TSharedPtr<FJsonValue> > JLODSections;
+	for (const FSkeletalMeshLODRenderData& LODResource : LODRenderData)
+	{
+		JLODSections.Add(MakeShareable(new FJsonValueNumber(LODResource.RenderSections.Num())));
+	}
+	for (int32 Index = 0; GeneratedLODs != nullptr && Index < GeneratedLODs->Num(); ++Index)
+	{
+		JLODSections.Add(MakeShareable(new FJsonValueNumber(LODRenderData[0].RenderSections.Num())));
+	}
+	JsonObject->SetNumberField(TEXT("mesh_sections"), LODRenderData[0].RenderSections.Num());
+	JsonObject->SetArrayField(TEXT("lod_sections"), JLODSections);
 
 	TArray< TSharedPtr<FJsonValue> > JSKMActors;
 	for (const auto& A : Actors)
@@ -2009,8 +3231,10 @@ TSharedPtr<FJsonObject> UTiXExporterBPLibrary::ExportSkeletalMeshActors(const US
 	return JsonObject;
 }
 
-void UTiXExporterBPLibrary::ExportSceneTile(const FTiXSceneTile& SceneTile, const FString& WorldName, const FString& InExportPath)
+bool UTiXExporterBPLibrary::ExportSceneTile(const FTiXSceneTile& SceneTile, const FString& WorldName, const FString& InExportPath)
 {
+	FTiXExportSession& Session = FTiXExportSession::Get();
+
 	// Get dependencies
 	FDependency Dependency;
 	for (const auto& MeshIns : SceneTile.TileSMInstances)
@@ -2080,10 +3304,14 @@ void UTiXExporterBPLibrary::ExportSceneTile(const FTiXSceneTile& SceneTile, cons
 			JRCActor->SetStringField(TEXT("name"), RCActor->GetName());
 			JRCActor->SetStringField(TEXT("linked_cubemap"), WorldName + TEXT("/TC_") + RCActor->GetName() + TEXT(".tasset"));
 
-			UWorld* CurrentWorld = RCActor->GetWorld();
 			UReflectionCaptureComponent* RCComponent = RCActor->GetCaptureComponent();
-			FReflectionCaptureData ReadbackCaptureData;
-			CurrentWorld->Scene->GetReflectionCaptureData(RCComponent, ReadbackCaptureData);
+			FReflectionCaptureData LocalCaptureData;
+			const FReflectionCaptureData* CachedCaptureData = FTiXExportSession::Get().FindReflectionCaptureData(RCComponent);
+			if (CachedCaptureData == nullptr)
+			{
+				RCActor->GetWorld()->Scene->GetReflectionCaptureData(RCComponent, LocalCaptureData);
+			}
+			const FReflectionCaptureData& ReadbackCaptureData = CachedCaptureData != nullptr ? *CachedCaptureData : LocalCaptureData;
 			JRCActor->SetNumberField(TEXT("cubemap_size"), ReadbackCaptureData.CubemapSize);
 			JRCActor->SetNumberField(TEXT("average_brightness"), ReadbackCaptureData.AverageBrightness);
 			JRCActor->SetNumberField(TEXT("brightness"), ReadbackCaptureData.Brightness);
@@ -2105,53 +3333,53 @@ void UTiXExporterBPLibrary::ExportSceneTile(const FTiXSceneTile& SceneTile, cons
 		TArray< TSharedPtr<FJsonValue> > JTextures, JMaterialInstances, JMaterials, JSMs, JSKMs;
 		TArray< TSharedPtr<FJsonValue> > JAnims, JSkeletons;
 		// textures
-		for (const auto& Tex : Dependency.DependenciesTextures)
+		for (int32 TexId : Dependency.DependenciesTextures.Ids)
 		{
-			TSharedRef< FJsonValueString > JsonValue = MakeShareable(new FJsonValueString(Tex + ExtName));
+			TSharedRef< FJsonValueString > JsonValue = MakeShareable(new FJsonValueString(Session.GetInternedResourcePathName(TexId) + ExtName));
 			JTextures.Add(JsonValue);
 		}
 		JDependency->SetArrayField(TEXT("textures"), JTextures);
 		// Materials
-		for (const auto& Material : Dependency.DependenciesMaterials)
+		for (int32 MaterialId : Dependency.DependenciesMaterials.Ids)
 		{
-			TSharedRef< FJsonValueString > JsonValue = MakeShareable(new FJsonValueString(Material + ExtName));
+			TSharedRef< FJsonValueString > JsonValue = MakeShareable(new FJsonValueString(Session.GetInternedResourcePathName(MaterialId) + ExtName));
 			JMaterials.Add(JsonValue);
 		}
 		JDependency->SetArrayField(TEXT("materials"), JMaterials);
 		// Material instances
-		for (const auto& MaterialInstance : Dependency.DependenciesMaterialInstances)
+		for (int32 MaterialInstanceId : Dependency.DependenciesMaterialInstances.Ids)
 		{
-			TSharedRef< FJsonValueString > JsonValue = MakeShareable(new FJsonValueString(MaterialInstance + ExtName));
+			TSharedRef< FJsonValueString > JsonValue = MakeShareable(new FJsonValueString(Session.GetInternedResourcePathName(MaterialInstanceId) + ExtName));
 			JMaterialInstances.Add(JsonValue);
 		}
 		JDependency->SetArrayField(TEXT("material_instances"), JMaterialInstances);
 
 		// anims
-		for (const auto& Anim : Dependency.DependenciesAnims)
+		for (int32 AnimId : Dependency.DependenciesAnims.Ids)
 		{
-			TSharedRef< FJsonValueString > JsonValue = MakeShareable(new FJsonValueString(Anim + ExtName));
+			TSharedRef< FJsonValueString > JsonValue = MakeShareable(new FJsonValueString(Session.GetInternedResourcePathName(AnimId) + ExtName));
 			JAnims.Add(JsonValue);
 		}
 		JDependency->SetArrayField(TEXT("anims"), JAnims);
 		// skeletons
-		for (const auto& Sk : Dependency.DependenciesSkeletons)
+		for (int32 SkId : Dependency.DependenciesSkeletons.Ids)
 		{
-			TSharedRef< FJsonValueString > JsonValue = MakeShareable(new FJsonValueString(Sk + ExtName));
+			TSharedRef< FJsonValueString > JsonValue = MakeShareable(new FJsonValueString(Session.GetInternedResourcePathName(SkId) + ExtName));
 			JSkeletons.Add(JsonValue);
 		}
 		JDependency->SetArrayField(TEXT("skeletons"), JSkeletons);
 
 		// static meshes
-		for (const auto& Mesh : Dependency.DependenciesStaticMeshes)
+		for (int32 MeshId : Dependency.DependenciesStaticMeshes.Ids)
 		{
-			TSharedRef< FJsonValueString > JsonValue = MakeShareable(new FJsonValueString(Mesh + ExtName));
+			TSharedRef< FJsonValueString > JsonValue = MakeShareable(new FJsonValueString(Session.GetInternedResourcePathName(MeshId) + ExtName));
 			JSMs.Add(JsonValue);
 		}
 		JDependency->SetArrayField(TEXT("static_meshes"), JSMs);
 		// skeletal meshes
-		for (const auto& Mesh : Dependency.DependenciesSkeletalMeshes)
+		for (int32 MeshId : Dependency.DependenciesSkeletalMeshes.Ids)
 		{
-			TSharedRef< FJsonValueString > JsonValue = MakeShareable(new FJsonValueString(Mesh + ExtName));
+			TSharedRef< FJsonValueString > JsonValue = MakeShareable(new FJsonValueString(Session.GetInternedResourcePathName(MeshId) + ExtName));
 			JSKMs.Add(JsonValue);
 		}
 		JDependency->SetArrayField(TEXT("skeletal_meshes"), JSKMs);
@@ -2187,154 +3415,288 @@ void UTiXExporterBPLibrary::ExportSceneTile(const FTiXSceneTile& SceneTile, cons
 		JsonObject->SetArrayField(TEXT("skeletal_mesh_actors"), JSKMActors);
 	}
 
-	FString FinalExportPath = InExportPath;
-	FinalExportPath.ReplaceInline(TEXT("\\"), TEXT("/"));
-	if (FinalExportPath[FinalExportPath.Len() - 1] != '/')
-		FinalExportPath.AppendChar('/');
-	FinalExportPath += WorldName + TEXT("/");
+	const FString FinalExportPath = NormalizeExportPath(InExportPath) + WorldName + TEXT("/");
 
-	SaveJsonToFile(JsonObject, TileName, FinalExportPath);
+	return SaveJsonToFile(JsonObject, TileName, FinalExportPath);
 }
 
-void UTiXExporterBPLibrary::GetStaticMeshDependency(const UStaticMesh * StaticMesh, const FString& InExportPath, FDependency& Dependency)
+FString UTiXExporterBPLibrary::GetSceneTileCacheKey(const FTiXSceneTile& SceneTile, const FString& WorldName)
 {
-	FString MeshPathName = CombineResourceExportPath(StaticMesh, InExportPath);
-	Dependency.DependenciesStaticMeshes.AddUnique(MeshPathName);
-
-	if (TiXExporterSetting.bIgnoreMaterial)
+	FTiXExportSession& Session = FTiXExportSession::Get();
+	if (!Session.IsActive())
 	{
-		// Ignore materials, do not output dependency
-		return;
+		return FString();
 	}
 
-	// Add material instance
-	const int32 CurrentLOD = 0;
-	FStaticMeshLODResources& LODResource = StaticMesh->RenderData->LODResources[CurrentLOD];
-
-	for (int32 Section = 0; Section < LODResource.Sections.Num(); ++Section)
+	FSHA1 HashState;
+	bool bCacheable = true;
+	auto HashString = [&HashState](const FString& String)
 	{
-		FStaticMeshSection& MeshSection = LODResource.Sections[Section];
-		UMaterialInterface* MaterialInterface = StaticMesh->StaticMaterials[MeshSection.MaterialIndex].MaterialInterface;
+		HashState.UpdateWithString(*String, String.Len());
+	};
+	auto HashAsset = [&](const UObject* Asset)
+	{
+		const FString AssetKey = Session.GetAssetCacheKey(Asset);
+		bCacheable &= !AssetKey.IsEmpty();
+		HashString(AssetKey);
+	};
+	auto HashMaterial = [&](const UMaterialInterface* MaterialInterface)
+	{
+		// Keys of material instances cover their parent chain
+		if (MaterialInterface != nullptr)
+		{
+			HashAsset(MaterialInterface);
+		}
+	};
 
-		if (MaterialInterface->IsA(UMaterial::StaticClass()))
+	HashString(WorldName);
+	HashState.Update((const uint8*)&SceneTile.Position, sizeof(FIntPoint));
+	for (const auto& MeshIns : SceneTile.TileSMInstances)
+	{
+		const UStaticMesh* Mesh = MeshIns.Key;
+		HashAsset(Mesh);
+		if (!TiXExporterSetting.bIgnoreMaterial)
 		{
-			// Materials
-			UMaterial * Material = Cast<UMaterial>(MaterialInterface);
-			FString MaterialPathName = CombineResourceExportPath(Material, InExportPath);
-			Dependency.DependenciesMaterials.AddUnique(MaterialPathName);
+			for (const auto& StaticMaterial : Mesh->StaticMaterials)
+			{
+				HashMaterial(StaticMaterial.MaterialInterface);
+			}
 		}
-		else
+		for (const auto& Instance : MeshIns.Value)
 		{
-			// Material instances
-			check(MaterialInterface->IsA(UMaterialInstance::StaticClass()));
-			UMaterialInstance * MaterialInstance = Cast<UMaterialInstance>(MaterialInterface);
-			FString MIPathName = CombineResourceExportPath(MaterialInstance, InExportPath);
-			Dependency.DependenciesMaterialInstances.AddUnique(MIPathName);
-
-			// Parent Materials
-			UMaterialInterface* ParentMaterial = MaterialInstance->Parent;
-			while (ParentMaterial && !ParentMaterial->IsA(UMaterial::StaticClass()))
+			HashState.Update((const uint8*)&Instance.Position, sizeof(FVector));
+			HashState.Update((const uint8*)&Instance.Rotation, sizeof(FQuat));
+			HashState.Update((const uint8*)&Instance.Scale, sizeof(FVector));
+		}
+	}
+	for (const auto& MeshActors : SceneTile.TileSKMActors)
+	{
+		const USkeletalMesh* Mesh = MeshActors.Key;
+		HashAsset(Mesh);
+		HashAsset(Mesh->Skeleton);
+		if (!TiXExporterSetting.bIgnoreMaterial)
+		{
+			for (const auto& SkeletalMaterial : Mesh->Materials)
 			{
-				check(ParentMaterial->IsA(UMaterialInstance::StaticClass()));
-				UMaterialInstance* ParentMaterialInstance = Cast<UMaterialInstance>(ParentMaterial);
-				ParentMaterial = ParentMaterialInstance->Parent;
+				HashMaterial(SkeletalMaterial.MaterialInterface);
 			}
-			check(ParentMaterial != nullptr);
-			UMaterial * Material = Cast<UMaterial>(ParentMaterial);
-			FString MaterialPathName = CombineResourceExportPath(Material, InExportPath);
-			Dependency.DependenciesMaterials.AddUnique(MaterialPathName);
-
-			// Add textures
-			for (int32 i = 0; i < MaterialInstance->TextureParameterValues.Num(); ++i)
+		}
+		for (const auto& A : MeshActors.Value)
+		{
+			const FTransform& Trans = A->GetTransform();
+			const FVector Position = Trans.GetTranslation();
+			const FQuat Rotation = Trans.GetRotation();
+			const FVector Scale = Trans.GetScale3D();
+			HashState.Update((const uint8*)&Position, sizeof(FVector));
+			HashState.Update((const uint8*)&Rotation, sizeof(FQuat));
+			HashState.Update((const uint8*)&Scale, sizeof(FVector));
+			UAnimSingleNodeInstance* SingleNodeInstance = A->GetSkeletalMeshComponent()->GetSingleNodeInstance();
+			if (SingleNodeInstance != nullptr && SingleNodeInstance->CurrentAsset != nullptr)
 			{
-				const FTextureParameterValue& TextureValue = MaterialInstance->TextureParameterValues[i];
-
-				UTexture * Texture = TextureValue.ParameterValue;
-				FString TexturePathName = CombineResourceExportPath(Texture, InExportPath);
-				if (!Texture->IsA(UTexture2D::StaticClass()))
-				{
-					continue;
-				}
-				Dependency.DependenciesTextures.AddUnique(TexturePathName);
+				HashAsset(SingleNodeInstance->CurrentAsset);
 			}
 		}
 	}
+	for (const auto& RCActor : SceneTile.ReflectionCaptures)
+	{
+		HashString(RCActor->GetName());
+		const FVector RCPosition = RCActor->GetTransform().GetLocation();
+		HashState.Update((const uint8*)&RCPosition, sizeof(FVector));
+		const FReflectionCaptureData* CaptureData = Session.FindReflectionCaptureData(RCActor->GetCaptureComponent());
+		if (CaptureData != nullptr)
+		{
+			HashState.Update((const uint8*)&CaptureData->CubemapSize, sizeof(int32));
+			HashState.Update((const uint8*)&CaptureData->AverageBrightness, sizeof(float));
+			HashState.Update((const uint8*)&CaptureData->Brightness, sizeof(float));
+		}
+	}
+	HashState.Final();
+
+	if (!bCacheable)
+	{
+		return FString();
+	}
+	FSHAHash Hash;
+	HashState.GetHash(Hash.Hash);
+	return Hash.ToString();
 }
 
-void UTiXExporterBPLibrary::GetSkeletalMeshDependency(const USkeletalMesh* SkeletalMesh, const FString& InExportPath, FDependency& Dependency)
+void UTiXExporterBPLibrary::CreateExportDirectories(const TArray<const UObject*>& Resources, const FString& WorldName, const FString& InExportPath)
 {
-	FString MeshPathName = CombineResourceExportPath(SkeletalMesh, InExportPath);
-	Dependency.DependenciesSkeletalMeshes.AddUnique(MeshPathName);
+	// Collect directories of resources and their dependencies
+	FDependency Dependency;
+	for (const UObject* Resource : Resources)
+	{
+		if (const UStaticMesh* StaticMesh = Cast<UStaticMesh>(Resource))
+		{
+			GetStaticMeshDependency(StaticMesh, InExportPath, Dependency);
+		}
+		else if (const USkeletalMesh* SkeletalMesh = Cast<USkeletalMesh>(Resource))
+		{
+			GetSkeletalMeshDependency(SkeletalMesh, InExportPath, Dependency);
+		}
+		else
+		{
+			Dependency.DependenciesAnims.Add(FTiXExportSession::Get().InternResource(Resource));
+		}
+	}
 
-	// Skeleton and Anim dependencies
-	USkeleton* Skeleton = SkeletalMesh->Skeleton;
-	FString SkeletonPathName = CombineResourceExportPath(Skeleton, InExportPath);
-	Dependency.DependenciesSkeletons.AddUnique(SkeletonPathName);
+	TSet<FString> Directories;
+	const FString ExportPath = NormalizeExportPath(InExportPath);
+	Directories.Add(ExportPath);
+	Directories.Add(ExportPath + WorldName + TEXT("/"));
+	for (const FTiXResourceIdSet* ResourceIds : { 
+		&Dependency.DependenciesStaticMeshes, &Dependency.DependenciesSkeletalMeshes, 
+		&Dependency.DependenciesMaterialInstances, &Dependency.DependenciesMaterials, 
+		&Dependency.DependenciesTextures, &Dependency.DependenciesSkeletons, &Dependency.DependenciesAnims })
+	{
+		for (int32 ResourceId : ResourceIds->Ids)
+		{
+			const FString& ResourcePathName = FTiXExportSession::Get().GetInternedResourcePathName(ResourceId);
+			int32 SlashIndex;
+			Directories.Add(ResourcePathName.FindLastChar('/', SlashIndex) ? ExportPath + ResourcePathName.Left(SlashIndex + 1) : ExportPath);
+		}
+	}
+
+	// Parent directories go first, so each directory is created with one system call
+	TArray<FString> SortedDirectories = Directories.Array();
+	SortedDirectories.Sort();
+	for (FString& Dir : SortedDirectories)
+	{
+		if (!VerifyOrCreateDirectory(Dir))
+		{
+			UE_LOG(LogTiXExporter, Error, TEXT("Failed to create directory : %s."), *Dir);
+		}
+	}
+	UE_LOG(LogTiXExporter, Log, TEXT("  Created %d export directories."), SortedDirectories.Num());
+}
+
+void UTiXExporterBPLibrary::ExportMeshMaterials(const UStaticMesh* StaticMesh, const FString& InExportPath)
+{
+	if (TiXExporterSetting.bIgnoreMaterial)
+	{
+		return;
+	}
+	TArray<UMaterialInterface*> Materials;
+	GetMeshMaterials(StaticMesh, Materials);
+	for (UMaterialInterface* MaterialInterface : Materials)
+	{
+		ExportMaterialInstance(MaterialInterface, InExportPath);
+	}
+}
+
+void UTiXExporterBPLibrary::ExportMeshMaterials(const USkeletalMesh* SkeletalMesh, const FString& InExportPath)
+{
+	ExportSkeleton(SkeletalMesh->Skeleton, InExportPath);
+	if (TiXExporterSetting.bIgnoreMaterial)
+	{
+		return;
+	}
+	TArray<UMaterialInterface*> Materials;
+	GetMeshMaterials(SkeletalMesh, Materials);
+	for (UMaterialInterface* MaterialInterface : Materials)
+	{
+		ExportMaterialInstance(MaterialInterface, InExportPath);
+	}
+}
 
-	// Material dependencies
-	if (!TiXExporterSetting.bIgnoreMaterial)
+static void GetMaterialDependency(const UMaterialInterface* MaterialInterface, FDependency& Dependency)
+{
+	FTiXExportSession& Session = FTiXExportSession::Get();
+	if (MaterialInterface->IsA(UMaterial::StaticClass()))
 	{
-		FSkeletalMeshRenderData* SKMRenderData = SkeletalMesh->GetResourceForRendering();
+		// Materials
+		Dependency.DependenciesMaterials.Add(Session.InternResource(MaterialInterface));
+	}
+	else
+	{
+		// Material instances
+		check(MaterialInterface->IsA(UMaterialInstance::StaticClass()));
+		const UMaterialInstance* MaterialInstance = Cast<UMaterialInstance>(GetExportedMaterial(const_cast<UMaterialInterface*>(MaterialInterface)));
+		Dependency.DependenciesMaterialInstances.Add(Session.InternResource(MaterialInstance));
+
+		// Root material, intermediate instances are flattened
+		FTiXFlattenedMaterialInstance Flattened;
+		FlattenMaterialInstance(MaterialInstance, Flattened);
+		Dependency.DependenciesMaterials.Add(Session.InternResource(Flattened.RootMaterial));
 
-		// Add material instance
-		const int32 CurrentLOD = 0;
-		FSkeletalMeshLODRenderData& LODResource = SKMRenderData->LODRenderData[CurrentLOD];
-		for (int32 Section = 0; Section < LODResource.RenderSections.Num(); ++Section)
+		// Add textures
+		for (int32 i = 0; i < Flattened.TextureParameters.Num(); ++i)
 		{
-			FSkelMeshRenderSection& MeshSection = LODResource.RenderSections[Section];
-			FSkeletalMaterial SkeletalMaterial = SkeletalMesh->Materials[MeshSection.MaterialIndex];
-			UMaterialInterface* MaterialInterface = SkeletalMaterial.MaterialInterface;
+			const FTextureParameterValue& TextureValue = Flattened.TextureParameters[i];
 
-			if (MaterialInterface->IsA(UMaterial::StaticClass()))
+			UTexture* Texture = TextureValue.ParameterValue;
+			if (!Texture->IsA(UTexture2D::StaticClass()))
 			{
-				// Materials
-				UMaterial* Material = Cast<UMaterial>(MaterialInterface);
-				FString MaterialPathName = CombineResourceExportPath(Material, InExportPath);
-				Dependency.DependenciesMaterials.AddUnique(MaterialPathName);
+				continue;
 			}
-			else
+			if (const FTiXTextureDuplicate* Duplicate = Session.FindTextureDuplicate(Texture))
 			{
-				// Material instances
-				check(MaterialInterface->IsA(UMaterialInstance::StaticClass()));
-				UMaterialInstance* MaterialInstance = Cast<UMaterialInstance>(MaterialInterface);
-				FString MIPathName = CombineResourceExportPath(MaterialInstance, InExportPath);
-				Dependency.DependenciesMaterialInstances.AddUnique(MIPathName);
-
-				// Parent Materials
-				UMaterialInterface* ParentMaterial = MaterialInstance->Parent;
-				while (ParentMaterial && !ParentMaterial->IsA(UMaterial::StaticClass()))
-				{
-					check(ParentMaterial->IsA(UMaterialInstance::StaticClass()));
-					UMaterialInstance* ParentMaterialInstance = Cast<UMaterialInstance>(ParentMaterial);
-					ParentMaterial = ParentMaterialInstance->Parent;
-				}
-				check(ParentMaterial != nullptr);
-				UMaterial* Material = Cast<UMaterial>(ParentMaterial);
-				FString MaterialPathName = CombineResourceExportPath(Material, InExportPath);
-				Dependency.DependenciesMaterials.AddUnique(MaterialPathName);
+				Texture = Duplicate->Representative;
+			}
+			Dependency.DependenciesTextures.Add(Session.InternResource(Texture));
+		}
+	}
+}
 
-				// Add textures
-				for (int32 i = 0; i < MaterialInstance->TextureParameterValues.Num(); ++i)
-				{
-					const FTextureParameterValue& TextureValue = MaterialInstance->TextureParameterValues[i];
+void UTiXExporterBPLibrary::GetStaticMeshDependency(const UStaticMesh * StaticMesh, const FString& InExportPath, FDependency& Dependency)
+{
+	FTiXExportSession& Session = FTiXExportSession::Get();
 
-					UTexture* Texture = TextureValue.ParameterValue;
-					FString TexturePathName = CombineResourceExportPath(Texture, InExportPath);
-					if (!Texture->IsA(UTexture2D::StaticClass()))
-					{
-						continue;
-					}
-					Dependency.DependenciesTextures.AddUnique(TexturePathName);
-				}
+	// Dependencies of a mesh are the same in every tile, collect them only once
+	const FDependency* MeshDependency = Session.FindDependencyClosure(StaticMesh);
+	if (MeshDependency == nullptr)
+	{
+		FDependency& Closure = Session.AddDependencyClosure(StaticMesh);
+		Closure.DependenciesStaticMeshes.Add(Session.InternResource(StaticMesh));
+
+		// Ignore materials, do not output dependency
+		if (!TiXExporterSetting.bIgnoreMaterial)
+		{
+			// Add material instance
+			TArray<UMaterialInterface*> Materials;
+			GetMeshMaterials(StaticMesh, Materials);
+			for (const UMaterialInterface* MaterialInterface : Materials)
+			{
+				GetMaterialDependency(MaterialInterface, Closure);
 			}
 		}
+		MeshDependency = &Closure;
 	}
+	Dependency.Append(*MeshDependency);
 }
 
-void UTiXExporterBPLibrary::GetAnimSequenceDependency(const ASkeletalMeshActor* SKMActor, const FString& InExportPath, FDependency& Dependency)
+void UTiXExporterBPLibrary::GetSkeletalMeshDependency(const USkeletalMesh* SkeletalMesh, const FString& InExportPath, FDependency& Dependency)
 {
-	USkeletalMesh* SkeletalMesh = SKMActor->GetSkeletalMeshComponent()->SkeletalMesh;
+	FTiXExportSession& Session = FTiXExportSession::Get();
+
+	const FDependency* MeshDependency = Session.FindDependencyClosure(SkeletalMesh);
+	if (MeshDependency == nullptr)
+	{
+		FDependency& Closure = Session.AddDependencyClosure(SkeletalMesh);
+		Closure.DependenciesSkeletalMeshes.Add(Session.InternResource(SkeletalMesh));
+
+		// Skeleton and Anim dependencies
+		Closure.DependenciesSkeletons.Add(Session.InternResource(SkeletalMesh->Skeleton));
+
+		// Material dependencies
+		if (!TiXExporterSetting.bIgnoreMaterial)
+		{
+			// Add material instance
+			TArray<UMaterialInterface*> Materials;
+			GetMeshMaterials(SkeletalMesh, Materials);
+			for (const UMaterialInterface* MaterialInterface : Materials)
+			{
+				GetMaterialDependency(MaterialInterface, Closure);
+			}
+		}
+		MeshDependency = &Closure;
+	}
+	Dependency.Append(*MeshDependency);
+}
 
+void UTiXExporterBPLibrary::GetAnimSequenceDependency(const ASkeletalMeshActor* SKMActor, const FString& InExportPath, FDependency& Dependency)
+{
 	if (SKMActor->GetSkeletalMeshComponent()->GetAnimationMode() == EAnimationMode::AnimationSingleNode)
 	{
 		// If Use Animation Asset, Export UAnimationAsset
@@ -2342,8 +3704,7 @@ void UTiXExporterBPLibrary::GetAnimSequenceDependency(const ASkeletalMeshActor*
 		UAnimationAsset* AnimAsset = SingleNodeInstance->CurrentAsset;
 		if (AnimAsset->IsA<UAnimSequence>())
 		{
-			FString AnimPathName = CombineResourceExportPath(AnimAsset, InExportPath);
-			Dependency.DependenciesAnims.AddUnique(AnimPathName);
+			Dependency.DependenciesAnims.Add(FTiXExportSession::Get().InternResource(AnimAsset));
 		}
 	}
-}
\ No newline at end of file
+}
@@ -10,6 +10,23 @@ struct FTiXExporterSetting
 	bool bIgnoreMaterial;
 	bool bEnableMeshCluster;
 	uint32 MeshClusterSize;
+	bool bEnableIncrementalExport;
+	bool bEnableMeshDeduplication;
+	bool bEnableTextureDeduplication;
+	bool bEnableMaterialInstanceDeduplication;
+	bool bEnableVertexWelding;
+	float VertexWeldEpsilon;
+	bool bEnableVertexCacheOptimization;
+	bool bEnableOverdrawOptimization;
+	float OverdrawCacheThreshold;
+	bool bEnableVertexFetchOptimization;
+	bool bEnableLODGeneration;
+	int32 TargetMeshLODs;
+	float LODTriangleRatio;
+	float LODMaxError;
+	bool bRemoveDegenerateTriangles;
+	float DegenerateAreaThreshold;
+	float SliverAspectThreshold;
 
 	FTiXExporterSetting()
 		: TileSize(16.f)
@@ -17,9 +34,29 @@ struct FTiXExporterSetting
 		, bIgnoreMaterial(false)
 		, bEnableMeshCluster(false)
 		, MeshClusterSize(128)
+		, bEnableIncrementalExport(false)
+		, bEnableMeshDeduplication(false)
+		, bEnableTextureDeduplication(false)
+		, bEnableMaterialInstanceDeduplication(false)
+		, bEnableVertexWelding(false)
+		, VertexWeldEpsilon(0.f)
+		, bEnableVertexCacheOptimization(false)
+		, bEnableOverdrawOptimization(false)
+		, OverdrawCacheThreshold(1.05f)
+		, bEnableVertexFetchOptimization(false)
+		, bEnableLODGeneration(false)
+		, TargetMeshLODs(4)
+		, LODTriangleRatio(0.5f)
+		, LODMaxError(0.01f)
+		, bRemoveDegenerateTriangles(false)
+		, DegenerateAreaThreshold(1e-8f)
+		, SliverAspectThreshold(1000.f)
 	{}
 };
 
+// Increase this when exported data changes, to invalidate incremental export caches.
+static const int32 TIX_EXPORT_CACHE_VERSION = 7;
+
 static const int32 MAX_TIX_TEXTURE_COORDS = 2;
 enum E_VERTEX_STREAM_SEGMENT
 {
@@ -35,23 +72,146 @@ enum E_VERTEX_STREAM_SEGMENT
 	EVSSEG_TOTAL = EVSSEG_BLENDWEIGHT,
 };
 
-struct FTiXVertex
+/**
+* Calls Functor.template Run<StreamMask>() with a runtime VsFormat as the compile time StreamMask,
+* so per vertex code is instantiated for each stream combination without stream branches.
+* Position is always on, blend index and blend weight are always together.
+*/
+template<uint32 StreamMask, uint32 Stream>
+struct TTiXVsFormatDispatch
 {
-	FVector Position;
-	FVector Normal;
-	FVector TangentX;
-	FVector2D TexCoords[MAX_TIX_TEXTURE_COORDS];
-	FVector4 Color;
-	FVector4 BlendIndex;
-	FVector4 BlendWeight;
-
-	FTiXVertex()
-		: Color(1.f, 1.f, 1.f, 1.f)
+	template<typename TFunctor>
+	static FORCEINLINE void Run(uint32 VsFormat, TFunctor& Functor)
+	{
+		if ((VsFormat & Stream) != 0)
+		{
+			TTiXVsFormatDispatch<StreamMask | Stream, (Stream << 1)>::Run(VsFormat, Functor);
+		}
+		else
+		{
+			TTiXVsFormatDispatch<StreamMask, (Stream << 1)>::Run(VsFormat, Functor);
+		}
+	}
+};
+
+template<uint32 StreamMask>
+struct TTiXVsFormatDispatch<StreamMask, EVSSEG_BLENDINDEX>
+{
+	template<typename TFunctor>
+	static FORCEINLINE void Run(uint32 VsFormat, TFunctor& Functor)
+	{
+		if ((VsFormat & EVSSEG_BLENDINDEX) != 0)
+		{
+			Functor.template Run<StreamMask | EVSSEG_BLENDINDEX | EVSSEG_BLENDWEIGHT>();
+		}
+		else
+		{
+			Functor.template Run<StreamMask>();
+		}
+	}
+};
+
+template<typename TFunctor>
+FORCEINLINE void DispatchVsFormat(uint32 VsFormat, TFunctor& Functor)
+{
+	check((VsFormat & EVSSEG_POSITION) != 0);
+	check(((VsFormat & EVSSEG_BLENDINDEX) != 0) == ((VsFormat & EVSSEG_BLENDWEIGHT) != 0));
+	TTiXVsFormatDispatch<EVSSEG_POSITION, EVSSEG_NORMAL>::Run(VsFormat, Functor);
+}
+
+// Bone indices of a skinned vertex, local to the bone map of its section
+struct FTiXBlendIndices
+{
+	uint16 Bones[4];
+};
+
+// Bone weights of a skinned vertex in 0 ~ 255
+struct FTiXBlendWeights
+{
+	uint8 Weights[4];
+};
+
+/**
+* Vertices stored as one array per stream, only streams in VsFormat are allocated.
+* Every active stream has Num() elements.
+*/
+struct FTiXVertexStreams
+{
+	uint32 VsFormat;
+	TArray<FVector> Positions;
+	TArray<FVector> Normals;
+	TArray<FColor> Colors;
+	TArray<FVector2D> TexCoords[MAX_TIX_TEXTURE_COORDS];
+	TArray<FVector> Tangents;
+	TArray<FTiXBlendIndices> BlendIndices;
+	TArray<FTiXBlendWeights> BlendWeights;
+
+	FTiXVertexStreams()
+		: VsFormat(0)
+	{}
+
+	explicit FTiXVertexStreams(uint32 InVsFormat)
+		: VsFormat(InVsFormat)
 	{}
 
-	bool operator == (const FTiXVertex& Other) const
+	int32 Num() const
+	{
+		return Positions.Num();
+	}
+
+	void Reserve(int32 NumVertices)
+	{
+		ForEachStream([NumVertices](auto& Stream) { Stream.Reserve(NumVertices); });
+	}
+
+	/** Resize active streams to NumVertices zeroed vertices. */
+	void SetNumZeroed(int32 NumVertices)
+	{
+		ForEachStream([NumVertices](auto& Stream) { Stream.Reset(NumVertices); Stream.AddZeroed(NumVertices); });
+	}
+
+	/** Call Func with each active stream array. */
+	template<typename TFunc>
+	void ForEachStream(TFunc Func)
+	{
+		Func(Positions);
+		if ((VsFormat & EVSSEG_NORMAL) != 0)
+			Func(Normals);
+		if ((VsFormat & EVSSEG_COLOR) != 0)
+			Func(Colors);
+		if ((VsFormat & EVSSEG_TEXCOORD0) != 0)
+			Func(TexCoords[0]);
+		if ((VsFormat & EVSSEG_TEXCOORD1) != 0)
+			Func(TexCoords[1]);
+		if ((VsFormat & EVSSEG_TANGENT) != 0)
+			Func(Tangents);
+		if ((VsFormat & EVSSEG_BLENDINDEX) != 0)
+			Func(BlendIndices);
+		if ((VsFormat & EVSSEG_BLENDWEIGHT) != 0)
+			Func(BlendWeights);
+	}
+
+	/** Append vertex SourceIndex of Source, StreamMask is the VsFormat of both. */
+	template<uint32 StreamMask>
+	FORCEINLINE int32 AddVertex(const FTiXVertexStreams& Source, int32 SourceIndex)
 	{
-		return FMemory::Memcmp(this, &Other, sizeof(FTiXVertex)) == 0;
+		checkSlow(VsFormat == StreamMask && Source.VsFormat == StreamMask);
+		const int32 Index = Positions.Add(Source.Positions[SourceIndex]);
+		if ((StreamMask & EVSSEG_NORMAL) != 0)
+			Normals.Add(Source.Normals[SourceIndex]);
+		if ((StreamMask & EVSSEG_COLOR) != 0)
+			Colors.Add(Source.Colors[SourceIndex]);
+		if ((StreamMask & EVSSEG_TEXCOORD0) != 0)
+			TexCoords[0].Add(Source.TexCoords[0][SourceIndex]);
+		if ((StreamMask & EVSSEG_TEXCOORD1) != 0)
+			TexCoords[1].Add(Source.TexCoords[1][SourceIndex]);
+		if ((StreamMask & EVSSEG_TANGENT) != 0)
+			Tangents.Add(Source.Tangents[SourceIndex]);
+		if ((StreamMask & EVSSEG_BLENDINDEX) != 0)
+			BlendIndices.Add(Source.BlendIndices[SourceIndex]);
+		if ((StreamMask & EVSSEG_BLENDWEIGHT) != 0)
+			BlendWeights.Add(Source.BlendWeights[SourceIndex]);
+		return Index;
 	}
 };
 
@@ -59,12 +219,23 @@ struct FTiXMeshSection
 {
 	uint32 IndexStart;
 	uint32 NumTriangles;
+	// Range of vertices referenced by this section, before BaseVertex is applied
+	uint32 MinVertex;
+	uint32 MaxVertex;
+	// Added to indices of this section, lets 16 bit indices address large meshes
+	uint32 BaseVertex;
+	// Material writes depth, triangle order of this section affects overdraw
+	bool bDepthWrite;
 	TArray<int32> BoneMap;
 
 	/** Constructor. */
 	FTiXMeshSection()
 		: IndexStart(0)
 		, NumTriangles(0)
+		, MinVertex(0)
+		, MaxVertex(0)
+		, BaseVertex(0)
+		, bDepthWrite(true)
 	{
 	}
 
@@ -74,6 +245,19 @@ struct FTiXMeshSection
 	}
 };
 
+/** Mesh LOD simplified from LOD0 at export, sections match sections of LOD0. */
+struct FTiXGeneratedLOD
+{
+	FTiXVertexStreams Vertices;
+	TArray<uint32> Indices;
+	TArray<FTiXMeshSection> Sections;
+	float ScreenSize;
+
+	FTiXGeneratedLOD()
+		: ScreenSize(0.f)
+	{}
+};
+
 struct FTiXInstance
 {
 	FVector Position;
@@ -83,15 +267,56 @@ struct FTiXInstance
 	FTransform Transform;
 };
 
+/** Set of interned resource ids, iterates in the order they first added. */
+struct FTiXResourceIdSet
+{
+	TArray<int32> Ids;
+	TSet<int32> IdSet;
+
+	void Add(int32 Id)
+	{
+		bool bAlreadyInSet = false;
+		IdSet.Add(Id, &bAlreadyInSet);
+		if (!bAlreadyInSet)
+		{
+			Ids.Add(Id);
+		}
+	}
+
+	void Append(const FTiXResourceIdSet& Other)
+	{
+		for (int32 Id : Other.Ids)
+		{
+			Add(Id);
+		}
+	}
+
+	int32 Num() const
+	{
+		return Ids.Num();
+	}
+};
+
 struct FDependency
 {
-	TArray<FString> DependenciesStaticMeshes;
-	TArray<FString> DependenciesSkeletalMeshes;
-	TArray<FString> DependenciesMaterialInstances;
-	TArray<FString> DependenciesMaterials;
-	TArray<FString> DependenciesTextures;
-	TArray<FString> DependenciesSkeletons;
-	TArray<FString> DependenciesAnims;
+	FTiXResourceIdSet DependenciesStaticMeshes;
+	FTiXResourceIdSet DependenciesSkeletalMeshes;
+	FTiXResourceIdSet DependenciesMaterialInstances;
+	FTiXResourceIdSet DependenciesMaterials;
+	FTiXResourceIdSet DependenciesTextures;
+	FTiXResourceIdSet DependenciesSkeletons;
+	FTiXResourceIdSet DependenciesAnims;
+
+	void Append(const FDependency& Other)
+	{
+		DependenciesStaticMeshes.Append(Other.DependenciesStaticMeshes);
+		DependenciesSkeletalMeshes.Append(Other.DependenciesSkeletalMeshes);
+		DependenciesMaterialInstances.Append(Other.DependenciesMaterialInstances);
+		DependenciesMaterials.Append(Other.DependenciesMaterials);
+		DependenciesTextures.Append(Other.DependenciesTextures);
+		DependenciesSkeletons.Append(Other.DependenciesSkeletons);
+		DependenciesAnims.Append(Other.DependenciesAnims);
+	}
 };
 
 class AReflectionCapture;
@@ -114,4 +339,42 @@ struct FTiXSceneTile
 		, SMInstanceCount(0)
 		, SKMActorCount(0)
 	{}
+};
+
+/** A static mesh with the same geometry as another mesh up to a rigid transform. */
+struct FTiXMeshDuplicate
+{
+	UStaticMesh* Representative;
+	// Transform from representative mesh space to this mesh space
+	FTransform RepresentativeToMesh;
+
+	FTiXMeshDuplicate()
+		: Representative(nullptr)
+	{}
+};
+
+/** A 2D texture with the same image as another texture, or as a lower mip of it. */
+struct FTiXTextureDuplicate
+{
+	class UTexture2D* Representative;
+	// Mip of representative that equals this texture
+	int32 MipBias;
+
+	FTiXTextureDuplicate()
+		: Representative(nullptr)
+		, MipBias(0)
+	{}
+};
+
+/** Instances and actors collected from a scene, before sorting into tiles. */
+struct FTiXSceneInstances
+{
+	TMap<UStaticMesh*, TArray<FTiXInstance> > SMInstances;
+	TMap<USkeletalMesh*, TArray<ASkeletalMeshActor*> > SKMActors;
+	TMap<USkeletalMesh*, class UAnimationAsset* > RelatedAnimations;
+	TArray< class ASkyLight* > SkyLightActors;
+	TArray< AReflectionCapture* > RCActors;
+
+	// Static meshes exported as their representatives, instances are folded in tiles
+	TMap<UStaticMesh*, FTiXMeshDuplicate> MeshDuplicates;
 };
\ No newline at end of file
@@ -10,6 +10,7 @@
 #include "Components/InstancedStaticMeshComponent.h"
 #include "Runtime/Engine/Classes/Engine/DirectionalLight.h"
 #include "Runtime/Engine/Classes/Components/LightComponent.h"
+#include "Materials/MaterialInstance.h"
 #include "RawMesh.h"
 #include "Serialization/JsonWriter.h"
 #include "Serialization/JsonSerializer.h"
@@ -17,6 +18,7 @@
 #include "Misc/FileHelper.h"
 #include "Serialization/BufferArchive.h"
 #include "ImageUtils.h"
+#include "FTiXExportSession.h"
 
 //DEFINE_LOG_CATEGORY(LogTiXExporter);
 void TryCreateDirectory(const FString& InTargetPath)
@@ -37,14 +39,20 @@ void TryCreateDirectory(const FString& InTargetPath)
 
 
 	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+	FTiXExportSession& Session = FTiXExportSession::Get();
 	FString TargetDir = "";
 	for (int32 Dir = 0; Dir < Dirs.Num(); ++Dir)
 	{
 		TargetDir += Dirs[Dir] + TEXT("/");
+		if (Session.IsDirectoryCreated(TargetDir))
+		{
+			continue;
+		}
 		if (!PlatformFile.DirectoryExists(*TargetDir))
 		{
 			PlatformFile.CreateDirectory(*TargetDir);
 		}
+		Session.MarkDirectoryCreated(TargetDir);
 	}
 }
 
@@ -56,6 +64,13 @@ bool VerifyOrCreateDirectory(FString& TargetDir)
 		TargetDir += TEXT("/");
 	}
 
+	// Created or verified before in this export session
+	FTiXExportSession& Session = FTiXExportSession::Get();
+	if (Session.IsDirectoryCreated(TargetDir))
+	{
+		return true;
+	}
+
 	IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
 
 	// Directory Exists? 
@@ -67,6 +82,7 @@ bool VerifyOrCreateDirectory(FString& TargetDir)
 	if (!PlatformFile.DirectoryExists(*TargetDir)) {
 		return false;
 	}
+	Session.MarkDirectoryCreated(TargetDir);
 	return true;
 }
 
@@ -197,36 +213,30 @@ void ConvertToJsonArray(const FSHVectorRGB3& SH3, TArray< TSharedPtr<FJsonValue>
 	ConvertToJsonArray(SH3.B.V, TSHVector<3>::NumTotalFloats, OutArray);
 }
 
-void SaveJsonToFile(TSharedPtr<FJsonObject> JsonObject, const FString& Name, const FString& Path)
+bool SaveJsonToFile(TSharedPtr<FJsonObject> JsonObject, const FString& Name, const FString& Path)
 {
 	FString OutputString;
 	TSharedRef< TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR> > > Writer = TJsonWriterFactory<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>::Create(&OutputString);
 	FJsonSerializer::Serialize(JsonObject.ToSharedRef(), Writer);
 
-	FString ExportPathStr = Path;
-	if (VerifyOrCreateDirectory(ExportPathStr))
-	{
-		FString PathName = ExportPathStr + Name + TEXT(".tjs");
-		FFileHelper::SaveStringToFile(OutputString, *PathName);
-	}
-	else
-	{
-		UE_LOG(LogTiXExporter, Error, TEXT("Failed to create directory : %s."), *ExportPathStr);
-	}
+	return SaveJsonToFile(OutputString, Name, Path);
 }
 
-void SaveJsonToFile(const FString& JsonString, const FString& Name, const FString& Path)
+bool SaveJsonToFile(const FString& JsonString, const FString& Name, const FString& Path)
 {
 	FString ExportPathStr = Path;
-	if (VerifyOrCreateDirectory(ExportPathStr))
+	if (!VerifyOrCreateDirectory(ExportPathStr))
 	{
-		FString PathName = ExportPathStr + Name + TEXT(".tjs");
-		FFileHelper::SaveStringToFile(JsonString, *PathName);
+		UE_LOG(LogTiXExporter, Error, TEXT("Failed to create directory : %s."), *ExportPathStr);
+		return false;
 	}
-	else
+	FString PathName = ExportPathStr + Name + TEXT(".tjs");
+	if (!FFileHelper::SaveStringToFile(JsonString, *PathName))
 	{
-		UE_LOG(LogTiXExporter, Error, TEXT("Failed to create directory : %s."), *ExportPathStr);
+		UE_LOG(LogTiXExporter, Error, TEXT("Failed to save %s."), *PathName);
+		return false;
 	}
+	return true;
 }
 
 void SaveUTextureToHDR(UTexture2D* Texture, const FString& FileName, const FString& Path)
@@ -278,39 +288,45 @@ void SaveUTextureToHDR(UTexture2D* Texture, const FString& FileName, const FStri
 	}
 }
 
-void ConvertToJsonArray(const TArray<FTiXVertex>& VertexArray, uint32 VsFormat, TArray< TSharedPtr<FJsonValue> >& OutArray)
+void ConvertToJsonArray(const FTiXVertexStreams& Vertices, TArray< TSharedPtr<FJsonValue> >& OutArray)
 {
-	for (const auto& v : VertexArray)
+	// Streams are interleaved per vertex in json
+	const uint32 VsFormat = Vertices.VsFormat;
+	const float OneOver255 = 1.f / 255.f;
+	for (int32 v = 0; v < Vertices.Num(); ++v)
 	{
-		ConvertToJsonArray(v.Position, OutArray);
+		ConvertToJsonArray(Vertices.Positions[v], OutArray);
 
 		if ((VsFormat & EVSSEG_NORMAL) != 0)
 		{
-			ConvertToJsonArray(v.Normal, OutArray);
+			ConvertToJsonArray(Vertices.Normals[v], OutArray);
 		}
 		if ((VsFormat & EVSSEG_COLOR) != 0)
 		{
-			ConvertToJsonArray(v.Color, OutArray);
+			const FColor& C = Vertices.Colors[v];
+			ConvertToJsonArray(FVector4(C.R * OneOver255, C.G * OneOver255, C.B * OneOver255, C.A * OneOver255), OutArray);
 		}
 		if ((VsFormat & EVSSEG_TEXCOORD0) != 0)
 		{
-			ConvertToJsonArray(v.TexCoords[0], OutArray);
+			ConvertToJsonArray(Vertices.TexCoords[0][v], OutArray);
 		}
 		if ((VsFormat & EVSSEG_TEXCOORD1) != 0)
 		{
-			ConvertToJsonArray(v.TexCoords[1], OutArray);
+			ConvertToJsonArray(Vertices.TexCoords[1][v], OutArray);
 		}
 		if ((VsFormat & EVSSEG_TANGENT) != 0)
 		{
-			ConvertToJsonArray(v.TangentX, OutArray);
+			ConvertToJsonArray(Vertices.Tangents[v], OutArray);
 		}
 		if ((VsFormat & EVSSEG_BLENDINDEX) != 0)
 		{
-			ConvertToJsonArray(v.BlendIndex, OutArray);
+			const FTiXBlendIndices& B = Vertices.BlendIndices[v];
+			ConvertToJsonArray(FVector4(B.Bones[0], B.Bones[1], B.Bones[2], B.Bones[3]), OutArray);
 		}
 		if ((VsFormat & EVSSEG_BLENDWEIGHT) != 0)
 		{
-			ConvertToJsonArray(v.BlendWeight, OutArray);
+			const FTiXBlendWeights& W = Vertices.BlendWeights[v];
+			ConvertToJsonArray(FVector4(W.Weights[0] * OneOver255, W.Weights[1] * OneOver255, W.Weights[2] * OneOver255, W.Weights[3] * OneOver255), OutArray);
 		}
 	}
 }
@@ -321,7 +337,36 @@ bool ContainComponent(const TArray<FString>& Components, const FString& CompName
 	return Components.Find(CompName) != INDEX_NONE;
 }
 
-FString GetResourcePath(const UObject * Resource)
+uint32 GetRequestedVsFormat(const TArray<FString>& Components)
+{
+	static const TCHAR* StreamNames[] =
+	{
+		TEXT("POSITION"),
+		TEXT("NORMAL"),
+		TEXT("COLOR"),
+		TEXT("TEXCOORD0"),
+		TEXT("TEXCOORD1"),
+		TEXT("TANGENT"),
+		TEXT("BLENDINDEX"),
+		TEXT("BLENDWEIGHT"),
+	};
+	static_assert((1 << (UE_ARRAY_COUNT(StreamNames) - 1)) == EVSSEG_TOTAL, "Stream names mismatch with E_VERTEX_STREAM_SEGMENT.");
+
+	uint32 VsFormat = 0;
+	for (const FString& Component : Components)
+	{
+		for (int32 Stream = 0; Stream < UE_ARRAY_COUNT(StreamNames); ++Stream)
+		{
+			if (Component == StreamNames[Stream])
+			{
+				VsFormat |= 1 << Stream;
+			}
+		}
+	}
+	return VsFormat;
+}
+
+void CalcResourcePaths(const UObject * Resource, FString& OutPath, FString& OutPathName)
 {
 	FString SM_GamePath = Resource->GetPathName();
 	SM_GamePath = SM_GamePath.Replace(TEXT("/Game/"), TEXT(""));
@@ -333,34 +378,80 @@ FString GetResourcePath(const UObject * Resource)
 	}
 	int32 SlashIndex;
 	bool LastSlash = SM_GamePath.FindLastChar('/', SlashIndex);
-	FString Path;
+	OutPath.Reset();
 	if (LastSlash)
 	{
-		Path = SM_GamePath.Mid(0, SlashIndex + 1);
+		OutPath = SM_GamePath.Mid(0, SlashIndex + 1);
+	}
+	OutPathName = OutPath + Resource->GetName();
+}
+
+FString GetResourcePath(const UObject * Resource)
+{
+	FTiXExportSession& Session = FTiXExportSession::Get();
+	if (Session.IsActive() && IsInGameThread())
+	{
+		return Session.GetResourcePaths(Resource).Path;
 	}
+	FString Path, PathName;
+	CalcResourcePaths(Resource, Path, PathName);
 	return Path;
 }
 
 FString GetResourcePathName(const UObject * Resource)
 {
-	return GetResourcePath(Resource) + Resource->GetName();
+	FTiXExportSession& Session = FTiXExportSession::Get();
+	if (Session.IsActive() && IsInGameThread())
+	{
+		return Session.GetResourcePaths(Resource).PathName;
+	}
+	FString Path, PathName;
+	CalcResourcePaths(Resource, Path, PathName);
+	return PathName;
 }
 
 FString CombineResourceExportPath(const UObject * Resource, const FString& InExportPath)
 {
-	FString Path = GetResourcePath(Resource);
+	return GetResourcePathName(Resource);
+}
+
+FString NormalizeExportPath(const FString& InExportPath)
+{
+	FTiXExportSession& Session = FTiXExportSession::Get();
+	if (Session.IsActive() && InExportPath == Session.GetRawExportPath())
+	{
+		return Session.GetExportPath();
+	}
 	FString ExportPath = InExportPath;
 	ExportPath.ReplaceInline(TEXT("\\"), TEXT("/"));
-	if (ExportPath[ExportPath.Len() - 1] != '/')
+	if (ExportPath.Len() == 0 || ExportPath[ExportPath.Len() - 1] != '/')
 		ExportPath.AppendChar('/');
-	FString ExportFullPath = ExportPath + Path;
+	return ExportPath;
+}
 
-	FString FullPathName = Path + Resource->GetName();
-	return FullPathName;
+FString GetResourceExportPath(const UObject * Resource, const FString& InExportPath)
+{
+	FTiXExportSession& Session = FTiXExportSession::Get();
+	if (Session.IsActive() && IsInGameThread() && InExportPath == Session.GetRawExportPath())
+	{
+		return Session.GetResourcePaths(Resource).ExportPath;
+	}
+	return NormalizeExportPath(InExportPath) + GetResourcePath(Resource);
 }
 
-TSharedPtr<FJsonObject> SaveMeshDataToJson(const TArray<FTiXVertex>& Vertices, const TArray<uint32>& Indices, int32 VsFormat)
+void GetMaterialParentChain(const UMaterialInterface* MaterialInterface, TArray<const UMaterialInterface*>& OutChain)
 {
+	while (MaterialInterface != nullptr)
+	{
+		OutChain.Add(MaterialInterface);
+		const UMaterialInstance* MaterialInstance = Cast<UMaterialInstance>(MaterialInterface);
+		MaterialInterface = MaterialInstance != nullptr ? MaterialInstance->Parent : nullptr;
+	}
+}
+
+TSharedPtr<FJsonObject> SaveMeshDataToJson(const FTiXVertexStreams& Vertices, const TArray<uint32>& Indices)
+{
+	const uint32 VsFormat = Vertices.VsFormat;
 	TSharedPtr<FJsonObject> JSection = MakeShareable(new FJsonObject);
 
 	TArray< TSharedPtr<FJsonValue> > IndicesArray, VerticesArray;
@@ -379,9 +470,17 @@ TSharedPtr<FJsonObject> SaveMeshDataToJson(const TArray<FTiXVertex>& Vertices, c
 
 	JSection->SetArrayField(TEXT("vs_format"), FormatArray);
 
-	ConvertToJsonArray(Vertices, VsFormat, VerticesArray);
+	ConvertToJsonArray(Vertices, VerticesArray);
 	JSection->SetArrayField(TEXT("vertices"), VerticesArray);
 
+	// Indices fit in 16 bits unless some vertex is beyond, after sections are rebased
+	uint32 MaxIndex = 0;
+	for (uint32 Index : Indices)
+	{
+		MaxIndex = FMath::Max(MaxIndex, Index);
+	}
+	JSection->SetStringField(TEXT("index_type"), MaxIndex <= MAX_uint16 ? TEXT("uint16") : TEXT("uint32"));
+
 	ConvertToJsonArray(Indices, IndicesArray);
 	JSection->SetArrayField(TEXT("indices"), IndicesArray);
 
@@ -396,6 +495,9 @@ TSharedPtr<FJsonObject> SaveMeshSectionToJson(const FTiXMeshSection& TiXSection,
 	JSection->SetStringField(TEXT("material"), MaterialInstanceName);
 	JSection->SetNumberField(TEXT("index_start"), TiXSection.IndexStart);
 	JSection->SetNumberField(TEXT("triangles"), TiXSection.NumTriangles);
+	JSection->SetNumberField(TEXT("min_vertex"), TiXSection.MinVertex);
+	JSection->SetNumberField(TEXT("max_vertex"), TiXSection.MaxVertex);
+	JSection->SetNumberField(TEXT("base_vertex"), TiXSection.BaseVertex);
 
 	TArray< TSharedPtr<FJsonValue> > JBoneMap;
 	ConvertToJsonArray(TiXSection.BoneMap, JBoneMap);
@@ -23,32 +23,53 @@ void ConvertToJsonArray(const TArray<int32>& IntArray, TArray< TSharedPtr<FJsonV
 void ConvertToJsonArray(const TArray<uint32>& UIntArray, TArray< TSharedPtr<FJsonValue> >& OutArray);
 void ConvertToJsonArray(const TArray<FVector>& VectorArray, TArray< TSharedPtr<FJsonValue> >& OutArray);
 void ConvertToJsonArray(const TArray<FVector2D>& VectorArray, TArray< TSharedPtr<FJsonValue> >& OutArray);
-void ConvertToJsonArray(const TArray<FTiXVertex>& VertexArray, uint32 VsFormat, TArray< TSharedPtr<FJsonValue> >& OutArray);
+void ConvertToJsonArray(const FTiXVertexStreams& Vertices, TArray< TSharedPtr<FJsonValue> >& OutArray);
 void ConvertToJsonArray(const TArray<FString>& StringArray, TArray< TSharedPtr<FJsonValue> >& OutArray);
 void ConvertToJsonArray(const float* FloatData, int32 Count, TArray< TSharedPtr<FJsonValue> >& OutArray);
 void ConvertToJsonArray(const FSHVectorRGB3& SH3, TArray< TSharedPtr<FJsonValue> >& OutArray);
 
-void SaveJsonToFile(TSharedPtr<FJsonObject> JsonObject, const FString& Name, const FString& Path);
-void SaveJsonToFile(const FString& JsonString, const FString& Name, const FString& Path);
+// Return false if the file could not be written
+bool SaveJsonToFile(TSharedPtr<FJsonObject> JsonObject, const FString& Name, const FString& Path);
+bool SaveJsonToFile(const FString& JsonString, const FString& Name, const FString& Path);
 void SaveUTextureToHDR(UTexture2D* Texture, const FString& FileName, const FString& Path);
 
 // Save mesh vertices and indices
-TSharedPtr<FJsonObject> SaveMeshDataToJson(const TArray<FTiXVertex>& Vertices, const TArray<uint32>& Indices, int32 VsFormat);
+TSharedPtr<FJsonObject> SaveMeshDataToJson(const FTiXVertexStreams& Vertices, const TArray<uint32>& Indices);
 
 // Save mesh sections info
 TSharedPtr<FJsonObject> SaveMeshSectionToJson(const FTiXMeshSection& TiXSection, const FString& SectionName, const FString& MaterialInstanceName);
 
 bool ContainComponent(const TArray<FString>& Components, const FString& CompName);
 
-/**
-* Creates a hash value from a FTiXVertex.
-*/
-inline uint32 GetTypeHash(const FTiXVertex& Vertex)
+// Parse mesh component names like "POSITION, NORMAL" into a E_VERTEX_STREAM_SEGMENT mask
+uint32 GetRequestedVsFormat(const TArray<FString>& Components);
+
+// Scene tile contains this position
+inline FIntPoint GetPointByPosition(const FVector& Position, float TileSize)
 {
-	// Note: this assumes there's no padding in FVector that could contain uncompared data.
-	return FCrc::MemCrc_DEPRECATED(&Vertex, sizeof(Vertex));
+	float X = Position.X / TileSize;
+	float Y = Position.Y / TileSize;
+	if (X < 0.f)
+	{
+		X -= 1.f;
+	}
+	if (Y < 0.f)
+	{
+		Y -= 1.f;
+	}
+	return FIntPoint(int32(X), int32(Y));
 }
 
 FString GetResourcePath(const UObject * Resource);
 FString GetResourcePathName(const UObject * Resource);
-FString CombineResourceExportPath(const UObject * Resource, const FString& InExportPath);
\ No newline at end of file
+FString CombineResourceExportPath(const UObject * Resource, const FString& InExportPath);
+
+// Path names computed from UObject::GetPathName(), without interning
+void CalcResourcePaths(const UObject * Resource, FString& OutPath, FString& OutPathName);
+// Export path with '/' separators and a '/' in the end
+FString NormalizeExportPath(const FString& InExportPath);
+// Directory a resource exported to, InExportPath + GetResourcePath(Resource)
+FString GetResourceExportPath(const UObject * Resource, const FString& InExportPath);
+
+// Material and its parents up to the root material, a material instance is flattened from all of them
+void GetMaterialParentChain(const UMaterialInterface* MaterialInterface, TArray<const UMaterialInterface*>& OutChain);
\ No newline at end of file
@@ -11,4 +11,19 @@ public:
 	/** IModuleInterface implementation */
 	virtual void StartupModule() override;
 	virtual void ShutdownModule() override;
+
+private:
+	void RegisterSceneChangeEvents();
+	void OnObjectPropertyChanged(UObject* Object, struct FPropertyChangedEvent& PropertyChangedEvent);
+	void OnLevelActorChanged(AActor* Actor);
+	void OnLevelActorDeleted(AActor* Actor);
+	void OnSceneChanged();
+
+	FDelegateHandle PostEngineInitHandle;
+	FDelegateHandle ObjectPropertyChangedHandle;
+	FDelegateHandle ActorMovedHandle;
+	FDelegateHandle LevelActorAddedHandle;
+	FDelegateHandle LevelActorDeletedHandle;
+	FDelegateHandle PostUndoRedoHandle;
+	FDelegateHandle LightingBuildKeptHandle;
 };
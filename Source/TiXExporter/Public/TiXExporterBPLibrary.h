@@ -149,6 +149,12 @@ public:
 	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Export Current Scene", Keywords = "TiX Export Current Scene"), Category = "TiXExporter")
 	static void ExportCurrentScene(AActor * Actor, const FString& ExportPath, const TArray<FString>& SceneComponents, const TArray<FString>& MeshComponents);
 
+	/** Export only scene tiles touched by editor changes since last Export Current Scene, and patch tile list of the scene.
+	Export whole scene if this scene is not exported to ExportPath with current tile settings before.
+	*/
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Export Dirty Scene Tiles", Keywords = "TiX Export Dirty Scene Tiles"), Category = "TiXExporter")
+	static void ExportDirtySceneTiles(AActor * Actor, const FString& ExportPath, const TArray<FString>& SceneComponents, const TArray<FString>& MeshComponents);
+
 	/** Export static mesh.
 	Param: Components should be combine of one or more in "POSITION, NORMAL, COLOR, TEXCOORD0, TEXCOORD1, TANGENT, BLENDINDEX, BLENDWEIGHT".
 	*/
@@ -187,9 +193,79 @@ public:
 	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Set Mesh Cluster Size", Keywords = "TiX Set Mesh Cluster Size"), Category = "TiXExporter")
 	static void SetMeshClusterSize(int32 Triangles);
 
+	/** Skip assets and scene tiles not changed since last export to the same path. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Set Enable Incremental Export", Keywords = "TiX Set Enable Incremental Export"), Category = "TiXExporter")
+	static void SetEnableIncrementalExport(bool bEnable);
+
+	/** Export static meshes with the same geometry up to a rigid transform once, as instances of one mesh. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Set Enable Mesh Deduplication", Keywords = "TiX Set Enable Mesh Deduplication"), Category = "TiXExporter")
+	static void SetEnableMeshDeduplication(bool bEnable);
+
+	/** Export textures with the same image once, smaller copies reference a mip of the larger one. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Set Enable Texture Deduplication", Keywords = "TiX Set Enable Texture Deduplication"), Category = "TiXExporter")
+	static void SetEnableTextureDeduplication(bool bEnable);
+
+	/** Export material instances with the same root material and resolved parameters once. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Set Enable Material Instance Deduplication", Keywords = "TiX Set Enable Material Instance Deduplication"), Category = "TiXExporter")
+	static void SetEnableMaterialInstanceDeduplication(bool bEnable);
+
+	/** Weld equal vertices of static meshes, instead of keeping the render data vertex buffer as is. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Set Enable Vertex Welding", Keywords = "TiX Set Enable Vertex Welding"), Category = "TiXExporter")
+	static void SetEnableVertexWelding(bool bEnable);
+
+	/** Vertex positions closer than this weld, other attributes always need to be equal. 0 welds equal vertices only. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Set Vertex Weld Epsilon", Keywords = "TiX Set Vertex Weld Epsilon"), Category = "TiXExporter")
+	static void SetVertexWeldEpsilon(float Epsilon);
+
+	/** Reorder triangles of each mesh section for the post-transform vertex cache. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Set Enable Vertex Cache Optimization", Keywords = "TiX Set Enable Vertex Cache Optimization"), Category = "TiXExporter")
+	static void SetEnableVertexCacheOptimization(bool bEnable);
+
+	/** Reorder triangle clusters of opaque and masked sections to reduce overdraw, implies vertex cache optimization. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Set Enable Overdraw Optimization", Keywords = "TiX Set Enable Overdraw Optimization"), Category = "TiXExporter")
+	static void SetEnableOverdrawOptimization(bool bEnable);
+
+	/** Vertex cache misses overdraw optimization may add, 1.05 allows 5% more. Larger values split finer clusters. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Set Overdraw Cache Threshold", Keywords = "TiX Set Overdraw Cache Threshold"), Category = "TiXExporter")
+	static void SetOverdrawCacheThreshold(float Threshold);
+
+	/** Renumber mesh vertices in the order triangles first use them, after triangles are reordered. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Set Enable Vertex Fetch Optimization", Keywords = "TiX Set Enable Vertex Fetch Optimization"), Category = "TiXExporter")
+	static void SetEnableVertexFetchOptimization(bool bEnable);
+
+	/** Simplify LOD0 of meshes with fewer render LODs than Target Mesh LODs into the missing coarser LODs. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Set Enable LOD Generation", Keywords = "TiX Set Enable LOD Generation"), Category = "TiXExporter")
+	static void SetEnableLODGeneration(bool bEnable);
+
+	/** Number of LODs generated LODs fill meshes up to, 1 ~ 8. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Set Target Mesh LODs", Keywords = "TiX Set Target Mesh LODs"), Category = "TiXExporter")
+	static void SetTargetMeshLODs(int32 NumLODs);
+
+	/** Triangles of each LOD relative to the LOD before it, 0.5 halves triangles per LOD. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Set LOD Triangle Ratio", Keywords = "TiX Set LOD Triangle Ratio"), Category = "TiXExporter")
+	static void SetLODTriangleRatio(float Ratio);
+
+	/** Largest simplification error of generated LODs relative to the mesh size, 0 limits triangle count only. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Set LOD Max Error", Keywords = "TiX Set LOD Max Error"), Category = "TiXExporter")
+	static void SetLODMaxError(float Error);
+
+	/** Remove zero area and sliver triangles of mesh sections before indices are optimized. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Set Remove Degenerate Triangles", Keywords = "TiX Set Remove Degenerate Triangles"), Category = "TiXExporter")
+	static void SetRemoveDegenerateTriangles(bool bRemove);
+
+	/** Triangles with an area up to this are removed, in exported units squared. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Set Degenerate Area Threshold", Keywords = "TiX Set Degenerate Area Threshold"), Category = "TiXExporter")
+	static void SetDegenerateAreaThreshold(float Area);
+
+	/** Triangles with the longest edge more than this times their height are removed, 0 keeps slivers. */
+	UFUNCTION(BlueprintCallable, meta = (DisplayName = "Set Sliver Aspect Threshold", Keywords = "TiX Set Sliver Aspect Threshold"), Category = "TiXExporter")
+	static void SetSliverAspectThreshold(float Aspect);
+
 private:
 	static void ExportStaticMeshFromRenderData(UStaticMesh* StaticMesh, const FString& Path, const TArray<FString>& Components);
 	static void ExportSkeletalMeshFromRenderData(USkeletalMesh* SkeletalMesh, FString ExportPath, const TArray<FString>& Components);
+	static TSharedPtr<FJsonObject> ExportStaticMeshLOD(UStaticMesh* StaticMesh, int32 LODIndex, const FTiXGeneratedLOD* GeneratedLOD, const FString& Path, const TArray<FString>& Components);
+	static TSharedPtr<FJsonObject> ExportSkeletalMeshLOD(USkeletalMesh* SkeletalMesh, int32 LODIndex, const FTiXGeneratedLOD* GeneratedLOD, const FString& Path, const TArray<FString>& Components);
 	static void ExportStaticMeshFromRawMesh(UStaticMesh* StaticMesh, const FString& Path, const TArray<FString>& Components);
 	static void ExportMaterialInstance(UMaterialInterface* InMaterial, const FString& Path);
 	static void ExportMaterial(UMaterialInterface* InMaterial, const FString& Path);
@@ -200,7 +276,16 @@ private:
 	static TSharedPtr<FJsonObject> ExportSkeletalMeshActors(const USkeletalMesh* InMesh, const TArray<ASkeletalMeshActor*>& Actors);
 	static TSharedPtr<FJsonObject> ExportMeshCollisions(const UStaticMesh* InMesh);
 
-	static void ExportSceneTile(const FTiXSceneTile& SceneTile, const FString& WorldName, const FString& InExportName);
+	static void FindTextureDuplicates(const FTiXSceneInstances& SceneInstances);
+	static void FindMaterialInstanceDuplicates(const FTiXSceneInstances& SceneInstances);
+	static void GenerateSceneMeshLODs(const FTiXSceneInstances& SceneInstances, const TArray<FString>& MeshComponents);
+	/** bFindDuplicates finds duplicates in SceneInstances, otherwise duplicates of the last full export are used. */
+	static void ExportSceneResources(const FTiXSceneInstances& SceneInstances, const FString& WorldName, const FString& ExportPath, const TArray<FString>& SceneComponents, const TArray<FString>& MeshComponents, bool bFindDuplicates);
+	static bool ExportSceneTile(const FTiXSceneTile& SceneTile, const FString& WorldName, const FString& InExportName);
+	static FString GetSceneTileCacheKey(const FTiXSceneTile& SceneTile, const FString& WorldName);
+	static void ExportMeshMaterials(const UStaticMesh* StaticMesh, const FString& InExportPath);
+	static void ExportMeshMaterials(const USkeletalMesh* SkeletalMesh, const FString& InExportPath);
+	static void CreateExportDirectories(const TArray<const UObject*>& Resources, const FString& WorldName, const FString& InExportPath);
 
 	static void GetStaticMeshDependency(const UStaticMesh* StaticMesh, const FString& InExportPath, FDependency& Dependency);
 	static void GetSkeletalMeshDependency(const USkeletalMesh* StaticMesh, const FString& InExportPath, FDependency& Dependency);